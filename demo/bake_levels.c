@@ -0,0 +1,134 @@
+#include "heightfield.h"
+#include "level_file.h"
+#include "terrain.h"
+#include "vector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const vector_t MIN = {0, 0};
+const double ARENA_SCREEN_HEIGHT = 500;
+const size_t TURN_LEN = 45;
+const double GROUND_SAMPLE_DX = 1.0;
+const double SPAWN_INSET = 100;
+const double CRATE_ZONE_MARGIN = 128;
+const char *DEFAULT_OUT_DIR = "assets/levels";
+
+typedef struct {
+  const char *file_name;
+  const char *background_path;
+  level_type_t type;
+  double width;
+  vector_t gravity;
+  double max_wind;
+  double air_drag;
+  color_t terrain_color;
+} arena_t;
+
+const arena_t ARENAS[] = {{.file_name = "forest.lvl",
+                           .background_path = "assets/forest.png",
+                           .type = FOREST,
+                           .width = 1000,
+                           .gravity = {0, -500},
+                           .max_wind = 125,
+                           .air_drag = 2e-4,
+                           .terrain_color = {0, 0.251, 0.051}},
+                          {.file_name = "mesa.lvl",
+                           .background_path = "assets/mesa.png",
+                           .type = MESA,
+                           .width = 1000,
+                           .gravity = {0, -500},
+                           .max_wind = 400,
+                           .air_drag = 1e-4,
+                           .terrain_color = {0.82, 0.42, 0}},
+                          {.file_name = "moon.lvl",
+                           .background_path = "assets/moon.png",
+                           .type = MOON,
+                           .width = 1000,
+                           .gravity = {0, -100},
+                           .max_wind = 0,
+                           .air_drag = 0,
+                           .terrain_color = {0.49, 0.49, 0.486}},
+                          // ten screens wide: the moon's low gravity lets a
+                          // full-power shot carry from one spawn to the other
+                          {.file_name = "moon_wide.lvl",
+                           .background_path = "assets/moon.png",
+                           .type = MOON,
+                           .width = 10000,
+                           .gravity = {0, -100},
+                           .max_wind = 0,
+                           .air_drag = 0,
+                           .terrain_color = {0.49, 0.49, 0.486}},
+                          // not in the game's menu: 1600 units is 320 surface
+                          // edges, so the last vertex ends a ground chunk,
+                          // which the simulator can exercise
+                          {.file_name = "forest_wide.lvl",
+                           .background_path = "assets/forest.png",
+                           .type = FOREST,
+                           .width = 1600,
+                           .gravity = {0, -500},
+                           .max_wind = 125,
+                           .air_drag = 2e-4,
+                           .terrain_color = {0, 0.251, 0.051}}};
+const size_t NUM_ARENAS = sizeof(ARENAS) / sizeof(ARENAS[0]);
+
+/**
+ * height_func_t that evaluates an arena's terrain generator.
+ */
+static double arena_height(double x, void *aux) {
+  const arena_t *arena = aux;
+  return terrain_height(arena->type, x, arena->width);
+}
+
+/**
+ * Bakes one arena into a level file.
+ *
+ * @param arena the arena to bake
+ * @param path the path of the level file to write
+ * @return whether the file was written
+ */
+static bool bake(const arena_t *arena, const char *path) {
+  vector_t max = {MIN.x + arena->width, MIN.y + ARENA_SCREEN_HEIGHT};
+  heightfield_t *ground = heightfield_init(
+      MIN.x, max.x, GROUND_SAMPLE_DX, arena_height, (void *)arena);
+
+  size_t num_vertices;
+  vector_t *surface = terrain_surface(arena->type, MIN, max, &num_vertices);
+
+  double left_x = MIN.x + SPAWN_INSET;
+  double right_x = max.x - SPAWN_INSET;
+  vector_t spawns[] = {{left_x, heightfield_height(ground, left_x)},
+                       {right_x, heightfield_height(ground, right_x)}};
+  level_zone_t crate_zones[] = {
+      {MIN.x + CRATE_ZONE_MARGIN, max.x - CRATE_ZONE_MARGIN}};
+
+  level_file_header_t header = {.gravity = arena->gravity,
+                                .max_wind = arena->max_wind,
+                                .air_drag = arena->air_drag,
+                                .terrain_color = arena->terrain_color,
+                                .screen_min = MIN,
+                                .screen_max = max,
+                                .turn_len = TURN_LEN};
+  strncpy(header.background_path, arena->background_path,
+          LEVEL_FILE_PATH_LEN - 1);
+
+  bool ok = level_file_write(path, header, ground, surface, num_vertices,
+                             spawns, 2, crate_zones, 1);
+  free(surface);
+  heightfield_free(ground);
+  return ok;
+}
+
+int main(int argc, char *argv[]) {
+  const char *out_dir = argc > 1 ? argv[1] : DEFAULT_OUT_DIR;
+  for (size_t i = 0; i < NUM_ARENAS; i++) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", out_dir, ARENAS[i].file_name);
+    if (!bake(&ARENAS[i], path)) {
+      fprintf(stderr, "failed to write %s\n", path);
+      return 1;
+    }
+    printf("wrote %s\n", path);
+  }
+  return 0;
+}
@@ -0,0 +1,117 @@
+#include "level_file.h"
+#include "match.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+const size_t DEFAULT_MATCHES = 1000;
+const unsigned int DEFAULT_SEED = 1;
+const double SIM_DT = 1.0 / 60;
+const double MAX_MATCH_TIME = 1800;
+const size_t MAX_SCRIPT_SHOTS = 1024;
+
+// lobs that land on player two on the built-in arenas when the wind is
+// calm, used when no script is given
+const scripted_shot_t DEFAULT_SHOTS[] = {
+    {.angle = 40 * M_PI / 180, .speed = 680, .arrow = ARROW_STANDARD},
+    {.angle = 30 * M_PI / 180, .speed = 700, .arrow = ARROW_STANDARD},
+    {.angle = 40 * M_PI / 180, .speed = 680, .arrow = ARROW_HEAVY},
+    {.angle = 50 * M_PI / 180, .speed = 730, .arrow = ARROW_MULTI},
+    {.angle = 40 * M_PI / 180, .speed = 670, .arrow = ARROW_STANDARD},
+    {.angle = 30 * M_PI / 180, .speed = 690, .arrow = ARROW_HEAVY}};
+const size_t NUM_DEFAULT_SHOTS =
+    sizeof(DEFAULT_SHOTS) / sizeof(DEFAULT_SHOTS[0]);
+const arrow_variant_t SCRIPT_ARROWS[] = {ARROW_STANDARD, ARROW_HEAVY,
+                                         ARROW_MULTI};
+
+/**
+ * Reads a shot script: one shot per line, as the launch angle in degrees,
+ * the launch speed, and the arrow key (1, 2 or 3) it is fired with. Lines
+ * starting with '#' are skipped.
+ *
+ * @param path the script file
+ * @param shots filled with up to MAX_SCRIPT_SHOTS shots
+ * @return the number of shots read, or -1 if the file could not be read
+ */
+static long read_script(const char *path, scripted_shot_t *shots) {
+  FILE *in = fopen(path, "r");
+  if (!in) {
+    return -1;
+  }
+  char line[256];
+  size_t n = 0;
+  while (n < MAX_SCRIPT_SHOTS && fgets(line, sizeof(line), in)) {
+    double angle_deg, speed;
+    int key;
+    if (line[0] == '#' ||
+        sscanf(line, "%lf %lf %d", &angle_deg, &speed, &key) != 3) {
+      continue;
+    }
+    if (key < 1 || key > 3) {
+      continue;
+    }
+    shots[n++] = (scripted_shot_t){.angle = angle_deg * M_PI / 180,
+                                   .speed = speed,
+                                   .arrow = SCRIPT_ARROWS[key - 1]};
+  }
+  fclose(in);
+  return n;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s level.lvl [matches] [first seed] [script]\n",
+            argv[0]);
+    return 1;
+  }
+  level_file_t *file = level_file_open(argv[1]);
+  if (!file) {
+    fprintf(stderr, "could not load level %s\n", argv[1]);
+    return 1;
+  }
+  level_file_close(file);
+  size_t matches = argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_MATCHES;
+  unsigned int seed = argc > 3 ? strtoul(argv[3], NULL, 10) : DEFAULT_SEED;
+
+  match_config_t config = {.level_path = argv[1],
+                           .shots = DEFAULT_SHOTS,
+                           .num_shots = NUM_DEFAULT_SHOTS,
+                           .dt = SIM_DT,
+                           .max_time = MAX_MATCH_TIME};
+  scripted_shot_t *script = NULL;
+  if (argc > 4) {
+    script = malloc(sizeof(scripted_shot_t) * MAX_SCRIPT_SHOTS);
+    long n = read_script(argv[4], script);
+    if (n < 0) {
+      fprintf(stderr, "could not read %s\n", argv[4]);
+      free(script);
+      return 1;
+    }
+    config.shots = script;
+    config.num_shots = n;
+  }
+
+  size_t wins[3] = {0};
+  size_t turns = 0;
+  size_t steps = 0;
+  clock_t start = clock();
+  for (size_t i = 0; i < matches; i++) {
+    config.seed = seed + i;
+    match_result_t result = match_run(&config);
+    wins[result.outcome]++;
+    turns += result.turns;
+    steps += result.steps;
+  }
+  double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("%zu matches: p1 %zu, p2 %zu, draw %zu\n", matches,
+         wins[MATCH_P1_WINS], wins[MATCH_P2_WINS], wins[MATCH_DRAW]);
+  printf("%.1f turns and %.0f steps per match\n",
+         matches ? (double)turns / matches : 0,
+         matches ? (double)steps / matches : 0);
+  printf("%.2f s, %.0f matches per minute\n", secs,
+         secs > 0 ? matches * 60 / secs : 0);
+  free(script);
+  return 0;
+}
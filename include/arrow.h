@@ -3,6 +3,7 @@
 
 #include "body.h"
 #include "camera.h"
+#include "contact_cache.h"
 #include "level.h"
 #include "scene.h"
 #include "vector.h"
@@ -14,18 +15,16 @@ typedef enum {
   ARROW_NVARIANTS
 } arrow_variant_t;
 
+/**
+ * What arrow_handle_pair() needs to know about the tick in progress.
+ */
 typedef struct {
-  vector_t position;
-  vector_t velocity;
-  double lifetime;
-  double max_lifetime;
-  double size;
-  color_t color;
-} particle_t;
+  contact_cache_t *contacts;
+} arrow_tick_t;
 
 /**
- * collision handler for an arrow, to be registered between the arrow and
- * any body that satisfies the separating axis theorem
+ * collision handler for an arrow, called by arrow_handle_pair() when the arrow
+ * and a target satisfy the separating axis theorem
  *
  * @param arrow arrow undergoing the collision
  * @param target target that could be hit by an arrow
@@ -37,51 +36,80 @@ void arrow_collision_handler(body_t *arrow, body_t *target, vector_t axis,
                              void *aux, double unused);
 
 /**
- * Allocates a new arrow object and registers collisions for that arrow.
- * Only creates collisions between the opposing player; other objects either
- * shouldnt collide with this arrow or do not satsify SAT.
+ * Allocates a new arrow object and records it as a live arrow so that
+ * arrow_handle_pair() can resolve its hits. No per-target force creators
+ * are registered.
  *
- * @param scene the scene the arrow is being added to
+ * @param level the level the arrow is being added to. The arrow is
+ *   integrated the way the level's trajectory predictions are.
  * @param shooter body the shot originates from
  * @param start_vel initial velocity
  * @param variant arrow variant (standard, heavy, multishot)
  *
  * @return a new arrow body, added to a scene
  */
-body_t *arrow_spawn(scene_t *scene, body_t *shooter, vector_t start_vel,
+body_t *arrow_spawn(level_t *level, body_t *shooter, vector_t start_vel,
                     arrow_variant_t variant);
 
 /**
- * Registers a particle trail for a given arrow
- * @param arrow the arrow to register a particle trail for
- * @param variant type of the arrow (standard, heavy, multishot)
+ * Pair handler for the level's broad phase. If one of the bodies is a live
+ * arrow and the other is an immovable target that is not the arrow's shooter
+ * or the ground, sweeps the arrow along its motion for the upcoming tick and
+ * applies the hit at the time of impact, so fast arrows cannot tunnel
+ * through thin targets. The hit is only applied when the contact cache
+ * reports that the arrow has just entered contact with the target.
+ *
+ * @param body1 first body of a candidate pair
+ * @param body2 second body of a candidate pair
+ * @param aux pointer to the arrow_tick_t for the upcoming tick
+ */
+void arrow_handle_pair(body_t *body1, body_t *body2, void *aux);
+
+/**
+ * Stops tracking arrows that have been marked for removal. Must be called
+ * before the level frees or reuses removed bodies.
  */
-void arrow_add_particle_trail(body_t *arrow, arrow_variant_t variant);
+void arrow_forget_removed();
 
 /**
- * Gets rid of any particles that have been coming
- * off the arrow for longer than PARTICLE_LIFETIME,
- * handles movement too.
+ * Stops tracking every arrow. To be called when the level holding the arrows
+ * is freed.
+ */
+void arrow_forget_all();
+
+/**
+ * Runs the trail emitter of every arrow in flight in a level (see
+ * emitter.h), then moves the level's particles and gets rid of those that
+ * have outlived their lifetime.
  *
  * @param level the level to update particles for
  * @param dt timestep
- * @param variant type of the arrow (standard, heavy, multishot)
  */
-void arrow_update_particles(level_t *level, double dt, arrow_variant_t variant);
+void arrow_update_particles(level_t *level, double dt);
 
 /**
- * Spawn "dust" burst when arrow hits the ground or a body
+ * Spawn "dust" burst when arrow hits the ground or a body. The dust is made
+ * of particles in the level's particle pool, not bodies.
  * @param level the level to spawn particles in
  * @param pos impact position
- * @param n number of particles in burst
  */
-void arrow_spawn_impact_burst(level_t *level, vector_t pos, size_t n);
+void arrow_spawn_impact_burst(level_t *level, vector_t pos);
 
 /**
  * To be called in state.c. Renders all partilces with
  * an alpha value proportional to how long they have been on screen
+ * @param level the level whose particles to render
  */
-void arrow_render_particles();
+void arrow_render_particles(level_t *level);
+
+/**
+ * Radius of the crater an arrow leaves when it hits the ground. Heavier
+ * arrows dig bigger craters.
+ * @param arrow the arrow hitting the ground
+ *
+ * @return the crater radius in world units
+ */
+double arrow_crater_radius(body_t *arrow);
 
 /**
  * Allows public access of ARROW_SPECS[]
@@ -92,16 +120,9 @@ double arrow_front_offset(arrow_variant_t variant);
 /**
  * Get rid of all onscreen particle effects. To be called
  * in turn_engine.c
+ * @param level the level whose particles to clear
  */
-void arrow_clear_particles();
-
-/**
- * @param level level to check for
- * @param body body to check
- *
- * @return false if not collided or not a particle, true if collided
- */
-bool particle_check_ground_collision(level_t *level, body_t *body);
+void arrow_clear_particles(level_t *level);
 
 /**
  * @param level level to check for
@@ -113,8 +134,9 @@ bool arrow_check_ground_collision(level_t *level, body_t *body);
 
 /**
  * Returns the amount of trail / impact particles to be rendered
+ * @param level the level whose particles to count
  */
-size_t arrow_get_particle_count();
+size_t arrow_get_particle_count(level_t *level);
 
 /**
  * Expose velocity scale argument for rendering shot
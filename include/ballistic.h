@@ -0,0 +1,65 @@
+#ifndef __BALLISTIC_H__
+#define __BALLISTIC_H__
+
+#include "heightfield.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * One way to hit a point: the launch angle and how long the flight takes.
+ */
+typedef struct {
+  // counterclockwise from the positive x axis, in radians
+  double angle;
+  double time;
+} ballistic_arc_t;
+
+/**
+ * Finds the launch angles that take a projectile from the origin through a
+ * point, given its launch speed and a constant acceleration, e.g. gravity
+ * plus wind. Exact for that model, which leaves out drag.
+ *
+ * Usually there are two: a low arc and a high arc, which is slower. They
+ * coincide when the speed is the least that reaches the point, and there
+ * are none if it is too slow. Without acceleration there is a single
+ * straight shot.
+ *
+ * @param offset where to hit, relative to the launch point
+ * @param speed the launch speed; must be positive
+ * @param accel the constant acceleration
+ * @param arcs filled with the solutions, fastest first
+ * @return the number of solutions: 0, 1 or 2
+ */
+size_t ballistic_solve(vector_t offset, double speed, vector_t accel,
+                       ballistic_arc_t arcs[2]);
+
+/**
+ * Computes where a projectile is on its arc at a given time.
+ *
+ * @param start the launch point
+ * @param vel the launch velocity
+ * @param accel the constant acceleration
+ * @param t the time since launch
+ * @return start + vel * t + accel * t^2 / 2
+ */
+vector_t ballistic_position(vector_t start, vector_t vel, vector_t accel,
+                            double t);
+
+/**
+ * Determines whether an arc stays above the terrain, sampled at evenly
+ * spaced times strictly between launch and the end of the flight. The
+ * endpoints are left out, since both usually sit on something standing on
+ * the ground.
+ *
+ * @param ground the terrain
+ * @param start the launch point
+ * @param vel the launch velocity
+ * @param accel the constant acceleration
+ * @param time how long the flight lasts
+ * @return whether every sample is above the ground
+ */
+bool ballistic_clears_terrain(const heightfield_t *ground, vector_t start,
+                              vector_t vel, vector_t accel, double time);
+
+#endif // #ifndef __BALLISTIC_H__
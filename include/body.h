@@ -2,14 +2,61 @@
 #define __BODY_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "color.h"
+#include "integrator.h"
 #include "list.h"
+#include "polygon.h"
+#include "shape.h"
 #include "vector.h"
 
+/**
+ * An axis-aligned bounding box.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
+/**
+ * What a body represents in the game. Tells callers how to interpret the
+ * body's info: players carry an `int32_t` HP and crates a `crate_info_t`.
+ */
+typedef enum {
+  BODY_UNKNOWN,
+  BODY_GROUND,
+  BODY_PLAYER,
+  BODY_ARROW,
+  BODY_CRATE,
+  NUM_BODY_KINDS
+} body_kind_t;
+
+/**
+ * Collision layers. A body sits on some layers and collides with bodies on
+ * the layers in its collision mask (see body_can_collide()).
+ */
+typedef enum {
+  LAYER_TERRAIN = 1 << 0,
+  LAYER_TARGET = 1 << 1,
+  LAYER_PROJECTILE = 1 << 2
+} collision_layer_t;
+
+/**
+ * Render layers, saying how a body is drawn.
+ */
+typedef enum {
+  /** Drawn as a filled polygon by sdl_render_scene() */
+  RENDER_SHAPE = 1 << 0,
+  /** Drawn by an image asset attached to the body */
+  RENDER_SPRITE = 1 << 1
+} render_layer_t;
+
 /**
  * A rigid body constrained to the plane.
- * Implemented as a polygon with uniform density.
+ * Implemented as a polygon with uniform density: a shape in local
+ * coordinates (see shape.h), which may be shared with other bodies, placed
+ * at the body's position and rotation.
  */
 typedef struct body body_t;
 
@@ -22,7 +69,8 @@ body_t *body_init(list_t *shape, double mass, color_t color);
 
 /**
  * Allocates memory for a body with the given parameters.
- * Gains ownership of the shape list.
+ * Gains ownership of the shape list, whose vertices are copied into a shape
+ * of the body's own (see shape.h).
  * The body is initially at rest.
  * Asserts that the required memory is allocated.
  *
@@ -38,13 +86,60 @@ body_t *body_init_with_info(list_t *shape, double mass, color_t color,
                             void *info, free_func_t info_freer);
 
 /**
- * Gets the current shape of a body.
- * Returns a newly allocated vector list, which must be list_free()d.
+ * Allocates memory for a body with a shared shape, placing the shape's
+ * centroid at a given position. The body takes its own reference to the
+ * shape, so nothing is copied.
+ *
+ * @param shape the body's shape
+ * @param centroid the body's initial center of mass
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body, or NULL
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_with_shape(shape_t *shape, vector_t centroid, double mass,
+                             color_t color, void *info,
+                             free_func_t info_freer);
+
+/**
+ * Turns a body that is no longer needed into a new one, as if it had been
+ * freed and a new body without info created with body_init_with_shape(),
+ * but reusing its memory. The old info is freed if the body has an info
+ * freer, and the buffer its world vertices are materialized into is kept.
+ *
+ * @param body the body to reuse; must not be in a scene or level any more
+ * @param shape the new body's shape
+ * @param centroid the new body's center of mass
+ * @param mass the mass of the new body
+ * @param color the color of the new body
+ */
+void body_recycle(body_t *body, shape_t *shape, vector_t centroid,
+                  double mass, color_t color);
+
+/**
+ * Gets the current outline of a body in world coordinates, with its edge
+ * normals, without copying it. It is worked out from the body's shape and
+ * pose the first time it is asked for after the body moves or turns, and
+ * cached until then.
+ * The returned polygon is owned by the body and stays valid until the body
+ * is next moved, rotated, ticked, or freed. It must not be modified.
  *
  * @param body the pointer to the body
- * @return a list of vectors
+ * @return the body's polygon
  */
-list_t *body_get_shape(body_t *body);
+const polygon_t *body_get_polygon(body_t *body);
+
+/**
+ * Gets the axis-aligned bounding box of a body's current vertices.
+ * The box of the rotated shape is cached on the body, so moving the body
+ * just shifts it, and it is only recomputed after the body turns. The world
+ * vertices are not materialized.
+ *
+ * @param body the pointer to the body
+ * @return the smallest axis-aligned box containing the body
+ */
+aabb_t body_get_aabb(body_t *body);
 
 /**
  * Return the info associated with a body.
@@ -54,6 +149,70 @@ list_t *body_get_shape(body_t *body);
  */
 void *body_get_info(body_t *body);
 
+/**
+ * Returns what kind of entity a body is.
+ * Bodies start out as BODY_UNKNOWN.
+ *
+ * @param body the pointer to the body
+ * @return the body's kind
+ */
+body_kind_t body_get_kind(body_t *body);
+
+/**
+ * Sets what kind of entity a body is.
+ *
+ * @param body the pointer to the body
+ * @param kind the body's kind
+ */
+void body_set_kind(body_t *body, body_kind_t kind);
+
+/**
+ * Sets which collision layers a body sits on and which it collides with.
+ * Bodies start out on no layers with an empty mask, so they collide with
+ * nothing.
+ *
+ * @param body the pointer to the body
+ * @param layers a bitwise OR of the collision_layer_t values the body is on
+ * @param mask a bitwise OR of the collision_layer_t values it collides with
+ */
+void body_set_collision_filter(body_t *body, uint32_t layers, uint32_t mask);
+
+/**
+ * Determines whether two bodies' collision filters let them collide: each
+ * body must sit on a layer in the other's mask.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether the pair should be tested for collisions
+ */
+bool body_can_collide(body_t *body1, body_t *body2);
+
+/**
+ * Determines whether a body's collision filter lets it collide with anything
+ * at all, i.e. whether it sits on some layer and has a non-empty mask.
+ *
+ * @param body the pointer to the body
+ * @return whether the body can be part of a colliding pair
+ */
+bool body_is_collidable(body_t *body);
+
+/**
+ * Returns the render layers a body is drawn on.
+ * Bodies start out on RENDER_SHAPE.
+ *
+ * @param body the pointer to the body
+ * @return a bitwise OR of render_layer_t values
+ */
+uint32_t body_get_render_layers(body_t *body);
+
+/**
+ * Sets the render layers a body is drawn on.
+ *
+ * @param body the pointer to the body
+ * @param layers a bitwise OR of render_layer_t values
+ */
+void body_set_render_layers(body_t *body, uint32_t layers);
+
 /**
  * Gets the current center of mass of a body.
  *
@@ -62,6 +221,18 @@ void *body_get_info(body_t *body);
  */
 vector_t body_get_centroid(body_t *body);
 
+/**
+ * Interpolates a body's center of mass between where it was before the last
+ * body_tick() and where it is now, for drawing it between two fixed steps.
+ * Moving the body with body_set_centroid() snaps it, so the next
+ * interpolation starts from the new position.
+ *
+ * @param body the pointer to the body
+ * @param alpha 0 for the centroid before the last tick, 1 for the current one
+ * @return the interpolated centroid
+ */
+vector_t body_get_interpolated_centroid(body_t *body, double alpha);
+
 /**
  * Translates a body to a new position.
  * The position is specified by the position of the body's center of mass.
@@ -130,12 +301,37 @@ double body_get_rotation(body_t *body);
  */
 void body_set_rotation(body_t *body, double angle);
 
+/**
+ * Chooses how body_tick() and body_predict() integrate a body's
+ * motion. Bodies start out on INTEGRATOR_VELOCITY_VERLET with no
+ * substepping.
+ *
+ * @param body the pointer to the body
+ * @param integrator the integration method
+ * @param max_step_travel the furthest the body may move in one substep
+ *   (see integrator_advance()), or INFINITY to take whole ticks
+ */
+void body_set_integrator(body_t *body, integrator_t integrator,
+                         double max_step_travel);
+
+/**
+ * Puts a body in an acceleration field, such as a level's force field (see
+ * force_field.h). The field's acceleration is added to that of the forces
+ * applied each tick, and is re-evaluated by the integrator wherever it
+ * samples the body's motion. Immovable bodies should not be given a field.
+ *
+ * @param body the pointer to the body
+ * @param field gives the field's acceleration, or NULL for none
+ * @param aux an auxiliary value to pass to `field`
+ */
+void body_set_accel_field(body_t *body, accel_func_t field, void *aux);
+
 /**
  * Updates the body after a given time interval has elapsed.
- * Sets acceleration and velocity according to the forces and impulses
- * applied to the body during the tick.
- * The body is translated at the *average* of the velocities before
- * and after the tick.
+ * The impulses applied during the tick change the velocity at its start,
+ * and the forces are held constant through it while the body's integrator
+ * (see body_set_integrator()) advances its position and velocity, along
+ * with its acceleration field (see body_set_accel_field()).
  * Resets the forces and impulses accumulated on the body.
  *
  * @param body the body to tick
@@ -143,6 +339,26 @@ void body_set_rotation(body_t *body, double angle);
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Integrates a body's motion over the coming tick, using the forces and
+ * impulses applied to it so far, and stores the result on the body.
+ * body_tick() with the same dt reuses it instead of integrating again,
+ * unless the body's centroid, velocity, forces or impulses change first.
+ *
+ * @param body the body to predict
+ * @param dt the number of seconds the body will be ticked for
+ */
+void body_predict(body_t *body, double dt);
+
+/**
+ * Returns the translation of a body's centroid found by the last
+ * body_predict(). It is not updated if the body changes afterwards.
+ *
+ * @param body the pointer to the body
+ * @return the translation the body's centroid will undergo this tick
+ */
+vector_t body_get_predicted_displacement(body_t *body);
+
 /**
  * Returns the mass of a body.
  *
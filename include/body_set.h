@@ -0,0 +1,62 @@
+#ifndef __BODY_SET_H__
+#define __BODY_SET_H__
+
+#include "body.h"
+#include <stddef.h>
+
+/**
+ * A growable array of bodies, used to keep the bodies of a level in
+ * separate partitions by how they move (see level.h). The bodies are kept in
+ * the order they were added, and can be walked directly through `bodies`.
+ * A set does not own its bodies.
+ */
+typedef struct body_set {
+  body_t **bodies;
+  size_t count;
+  size_t capacity;
+} body_set_t;
+
+/**
+ * Allocates memory for an empty body set.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @return the new set
+ */
+body_set_t *body_set_init(void);
+
+/**
+ * Appends a body to a set, growing it if needed.
+ *
+ * @param set the set to add to
+ * @param body the body to add
+ */
+void body_set_add(body_set_t *set, body_t *body);
+
+/**
+ * Removes the body at a given index from a set, shifting the bodies after it
+ * down so the rest stay in order. Does not free the body.
+ * Asserts that the index is valid.
+ *
+ * @param set the set to remove from
+ * @param index the index of the body to remove
+ * @return the removed body
+ */
+body_t *body_set_remove(body_set_t *set, size_t index);
+
+/**
+ * Determines whether a set holds a given body.
+ *
+ * @param set the set to search
+ * @param body the body to look for
+ * @return whether the body is in the set
+ */
+bool body_set_contains(const body_set_t *set, const body_t *body);
+
+/**
+ * Releases memory allocated for a set. Does not free any of its bodies.
+ *
+ * @param set the set to free
+ */
+void body_set_free(body_set_t *set);
+
+#endif // #ifndef __BODY_SET_H__
@@ -0,0 +1,83 @@
+#ifndef __BROAD_PHASE_H__
+#define __BROAD_PHASE_H__
+
+#include "body.h"
+#include "body_set.h"
+
+/**
+ * A sweep-and-prune broad phase over the axis-aligned bounding boxes of a
+ * level's bodies. Finds the pairs of bodies whose boxes overlap so the
+ * narrow phase (find_collision()) only runs on bodies that are close together.
+ * Static bodies are indexed separately and only re-indexed when they change,
+ * so each tick only costs as much as the bodies that are moving.
+ */
+typedef struct broad_phase broad_phase_t;
+
+/**
+ * A function called for each candidate pair found by the broad phase.
+ *
+ * @param body1 the first body of the pair
+ * @param body2 the second body of the pair
+ * @param aux an auxiliary value passed to broad_phase_query()
+ */
+typedef void (*pair_handler_t)(body_t *body1, body_t *body2, void *aux);
+
+/**
+ * Allocates memory for an empty broad phase.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @return the new broad phase
+ */
+broad_phase_t *broad_phase_init(void);
+
+/**
+ * Indexes the bodies that never move, replacing any indexed before. Their
+ * boxes are kept until the next call, so this must be called again whenever
+ * a static body is added or removed.
+ * Bodies that are marked for removal or cannot collide with anything (see
+ * body_is_collidable()) are left out.
+ *
+ * @param bp the broad phase to update
+ * @param bodies the static bodies
+ */
+void broad_phase_set_static(broad_phase_t *bp, const body_set_t *bodies);
+
+/**
+ * Rebuilds the bounding boxes of the moving bodies that are not marked for
+ * removal and can collide with something, and sorts them along the x axis.
+ * The box of a moving body covers everything it sweeps through over the
+ * next dt seconds, as found by body_predict(), so fast bodies still pair
+ * with targets they would pass through within one tick.
+ * Must be called after every moving body has been predicted for the tick
+ * and before broad_phase_query().
+ *
+ * @param bp the broad phase to update
+ * @param moving the sets of moving bodies to index
+ * @param num_sets the number of sets in `moving`
+ * @param dt the length of the upcoming tick
+ */
+void broad_phase_update(broad_phase_t *bp, body_set_t *const *moving,
+                        size_t num_sets, double dt);
+
+/**
+ * Calls a handler once for every pair of bodies whose bounding boxes overlap
+ * and at least one of which is moving.
+ * Pairs where both bodies have infinite mass are skipped, since immovable
+ * bodies never need to be tested against each other, as are pairs whose
+ * collision filters exclude each other (see body_can_collide()).
+ *
+ * @param bp the broad phase to query
+ * @param handler the function to call with each candidate pair
+ * @param aux an auxiliary value to pass to `handler`
+ */
+void broad_phase_query(broad_phase_t *bp, pair_handler_t handler, void *aux);
+
+/**
+ * Releases memory allocated for a broad phase.
+ * Does not free any of the bodies it indexed.
+ *
+ * @param bp the broad phase to free
+ */
+void broad_phase_free(broad_phase_t *bp);
+
+#endif // #ifndef __BROAD_PHASE_H__
@@ -5,6 +5,8 @@
 
 typedef struct camera {
   vector_t screen_min, screen_max;
+  // the part of the world the view is kept inside
+  vector_t world_min, world_max;
   vector_t center;
   double zoom;
 } camera_t;
@@ -13,10 +15,28 @@ typedef struct camera {
  * @param screen_min  bottom left world coords of the window
  * @param screen_max  top right world coords of the window
  *
- * @return a newly initialized camera
+ * @return a newly initialized camera, bounded to the window
  */
 camera_t *camera_init(vector_t screen_min, vector_t screen_max);
 
+/**
+ * Sets the part of the world the camera may show, for arenas larger than
+ * the window. Re-centers the camera inside the new bounds.
+ * @param cam the camera to bound
+ * @param world_min bottom left world coords of the arena
+ * @param world_max top right world coords of the arena
+ */
+void camera_set_bounds(camera_t *cam, vector_t world_min, vector_t world_max);
+
+/**
+ * Gets the part of the world currently in view.
+ * @param cam the camera to check
+ * @param view_min set to the bottom left world coords of the view
+ * @param view_max set to the top right world coords of the view
+ */
+void camera_get_view(const camera_t *cam, vector_t *view_min,
+                     vector_t *view_max);
+
 /**
  * Move camera center (world coords). Prevents camera from showing
  * anything outside of window bounds
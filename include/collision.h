@@ -23,8 +23,50 @@ typedef struct {
   vector_t axis;
 } collision_info_t;
 
+/**
+ * Represents the first contact between a moving shape and a stationary one.
+ */
+typedef struct {
+  /** Whether the moving shape touches the stationary one during the sweep */
+  bool collided;
+  /**
+   * The fraction of the displacement travelled before contact, in [0, 1].
+   * 0 means the shapes were already overlapping.
+   */
+  double time;
+  /** The point where the shapes first touch, in world coordinates */
+  vector_t point;
+  /**
+   * The unit normal of the struck edge, pointing from the first shape
+   * towards the second.
+   */
+  vector_t axis;
+} swept_collision_info_t;
+
+/**
+ * Determines whether two axis-aligned bounding boxes overlap.
+ * Boxes that only touch along an edge count as overlapping.
+ *
+ * @param box1 the first box
+ * @param box2 the second box
+ * @return whether the boxes overlap
+ */
+bool aabb_overlap(aabb_t box1, aabb_t box2);
+
+/**
+ * Extends a bounding box to cover everything it passes through while
+ * translating by a given displacement.
+ *
+ * @param box the box at the start of the move
+ * @param displacement how far the box moves
+ * @return the smallest box containing the box at both ends of the move
+ */
+aabb_t aabb_sweep(aabb_t box, vector_t displacement);
+
 /**
  * Computes the status of the collision between two bodies.
+ * Bodies whose bounding boxes do not overlap are rejected before any
+ * separating axis is projected.
  *
  * @param body1 the first body
  * @param body2 the second body
@@ -33,6 +75,49 @@ typedef struct {
  */
 collision_info_t find_collision(body_t *body1, body_t *body2);
 
+/**
+ * Computes the time of impact of a body translating by a given displacement
+ * against a stationary body. Both bodies must be convex. Unlike
+ * find_collision(), this cannot miss a thin target that the moving body
+ * passes completely through within one tick.
+ *
+ * @param body1 the moving body, at its position before the move
+ * @param displacement how far body1 moves over the interval
+ * @param body2 the stationary body
+ * @return whether body1 hits body2 during the move and, if so, when and where
+ */
+swept_collision_info_t find_swept_collision(body_t *body1,
+                                            vector_t displacement,
+                                            body_t *body2);
+
+/**
+ * Checks a single candidate axis between a body sweeping along a displacement
+ * and a stationary body. Costs one projection of each body, so it is the
+ * cheap first test when an axis is known to have separated them recently.
+ *
+ * @param body1 the moving body, at its position before the move
+ * @param displacement how far body1 moves over the interval
+ * @param body2 the stationary body
+ * @param axis a unit vector to project both bodies onto
+ * @return whether the axis proves body1 cannot touch body2 during the move
+ */
+bool is_separating_axis(body_t *body1, vector_t displacement, body_t *body2,
+                        vector_t axis);
+
+/**
+ * Searches for an axis that separates a body sweeping along a displacement
+ * from a stationary body. Both bodies must be convex. If none exists, body1
+ * touches body2 at some point during the move.
+ *
+ * @param body1 the moving body, at its position before the move
+ * @param displacement how far body1 moves over the interval
+ * @param body2 the stationary body
+ * @param axis set to a separating unit axis, if one is found
+ * @return whether a separating axis was found
+ */
+bool find_separating_axis(body_t *body1, vector_t displacement, body_t *body2,
+                          vector_t *axis);
+
 /**
  * used to analytically determine collisions with the ground for a certain
  * body type because our levels don't generally satisfy the separating axis
@@ -40,13 +125,12 @@ collision_info_t find_collision(body_t *body1, body_t *body2);
  *
  * @param level current level, necessary for computing level height
  * @param body body to check collision for
- * @param required_info info string a body must have for its collision to be
- * checked
+ * @param required_kind kind a body must be for its collision to be checked
  *
- * @return true if collision, false if body does not have required_info or no
+ * @return true if collision, false if body is not of required_kind or no
  * collision
  */
 bool alt_check_collision_certain_body(level_t *level, body_t *body,
-                                      const char *required_info);
+                                      body_kind_t required_kind);
 
 #endif // #ifndef __COLLISION_H__
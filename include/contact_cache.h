@@ -0,0 +1,87 @@
+#ifndef __CONTACT_CACHE_H__
+#define __CONTACT_CACHE_H__
+
+#include "body.h"
+#include "collision.h"
+#include "vector.h"
+
+/**
+ * Remembers, for every pair of bodies tested against each other, the axis
+ * that last separated them (or the axis of their last contact) and whether
+ * they were touching. The remembered axis is tried first on the next test,
+ * so pairs that stay apart are usually rejected with a single projection.
+ */
+typedef struct contact_cache contact_cache_t;
+
+/**
+ * How a pair's contact changed since the previous tick.
+ */
+typedef enum {
+  /** Apart this tick and the last */
+  CONTACT_NONE,
+  /** Touching this tick but not the last */
+  CONTACT_ENTER,
+  /** Touching this tick and the last */
+  CONTACT_STAY,
+  /** Touching last tick but not this one */
+  CONTACT_EXIT
+} contact_state_t;
+
+/**
+ * A function called for each touching pair that stopped being tested.
+ *
+ * @param body1 the first body of the pair
+ * @param body2 the second body of the pair
+ * @param aux an auxiliary value passed to contact_cache_end_tick()
+ */
+typedef void (*contact_exit_handler_t)(body_t *body1, body_t *body2,
+                                       void *aux);
+
+/**
+ * Allocates memory for an empty contact cache.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @return the new contact cache
+ */
+contact_cache_t *contact_cache_init(void);
+
+/**
+ * Tests a body sweeping along a displacement against a stationary body (see
+ * find_swept_collision()) and updates the pair's cached axis and contact.
+ * The order of the bodies does not matter for the cache: (a, b) and (b, a)
+ * share an entry.
+ *
+ * @param cache the cache to look the pair up in
+ * @param body1 the moving body, at its position before the move
+ * @param displacement how far body1 moves over the tick
+ * @param body2 the stationary body
+ * @param hit set to where and when the bodies touch; hit->collided is false
+ * if they do not
+ * @return how the pair's contact changed since the previous tick
+ */
+contact_state_t contact_cache_sweep(contact_cache_t *cache, body_t *body1,
+                                    vector_t displacement, body_t *body2,
+                                    swept_collision_info_t *hit);
+
+/**
+ * Ends a tick. Pairs that were not tested during the tick, or that contain a
+ * body marked for removal, are dropped from the cache; any of them that were
+ * touching are passed to `on_exit` first. Must be called once per tick,
+ * before the scene frees removed bodies.
+ *
+ * @param cache the cache to update
+ * @param on_exit if non-NULL, called for each dropped pair that was touching
+ * @param aux an auxiliary value to pass to `on_exit`
+ */
+void contact_cache_end_tick(contact_cache_t *cache,
+                            contact_exit_handler_t on_exit, void *aux);
+
+/**
+ * Releases memory allocated for a contact cache.
+ * Does not free any of the bodies it refers to.
+ *
+ * @param cache the cache to free
+ */
+void contact_cache_free(contact_cache_t *cache);
+
+#endif // #ifndef __CONTACT_CACHE_H__
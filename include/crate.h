@@ -5,8 +5,10 @@
 #include "level.h"
 #include <stdint.h>
 
+/**
+ * The info attached to bodies of kind BODY_CRATE.
+ */
 typedef struct {
-  const char *tag;
   int32_t hp;
 } crate_info_t;
 
@@ -22,13 +24,21 @@ bool crate_is(body_t *b);
 int32_t crate_get_hp(body_t *crate);
 
 /**
- * Spawn a crate at a random position in a level
+ * Spawn a crate at a random position in a level, unless one is already
+ * there. The crate is drawn as a plain shape until crate_add_sprite().
  * @param level current level object
  *
- * @returns crate body to be added to the level
+ * @returns the crate body, already added to the level, or NULL if none was
+ * spawned
  */
 body_t *crate_spawn(level_t *level);
 
+/**
+ * Draw a crate with the crate image instead of as a plain shape
+ * @param crate a body returned by crate_spawn()
+ */
+void crate_add_sprite(body_t *crate);
+
 /**
  * Render the hp label for a crate
  * @param scene current scene containing all bodies
@@ -0,0 +1,100 @@
+#ifndef __EMITTER_H__
+#define __EMITTER_H__
+
+#include "color.h"
+#include "particle.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * The particle effects in the game. How each looks is described by its
+ * effect_def_t, so effects are tuned in one table rather than in the code
+ * that spawns them.
+ */
+typedef enum {
+  // streams out behind an arrow in flight
+  EFFECT_TRAIL,
+  // thrown up where an arrow hits the ground
+  EFFECT_DUST,
+  // thrown out of a crate when it breaks
+  EFFECT_SPLINTERS,
+  NUM_EFFECTS
+} effect_t;
+
+/**
+ * How an effect's particles are made.
+ */
+typedef struct {
+  // particles per second while an emitter of the effect runs
+  double rate;
+  // particles per emitter_burst()
+  size_t burst_count;
+  double lifetime;
+  // see particle_pool_t
+  double size;
+  double weight;
+  // particles leave at most this many radians to either side of the
+  // emitter's direction, at a speed between min_speed and max_speed
+  double spread;
+  double min_speed;
+  double max_speed;
+  // the fraction of the emitter's own velocity particles carry along
+  double inherit;
+  color_t color;
+} effect_def_t;
+
+/**
+ * Emits an effect's particles continuously, at the effect's rate. Whole
+ * particles are emitted as soon as they are due and the fraction left over
+ * carries to the next update, so the number emitted per second does not
+ * depend on how often the emitter is updated.
+ */
+typedef struct {
+  effect_t effect;
+  // how many particles are owed, short of a whole one
+  double due;
+} emitter_t;
+
+/**
+ * Gets the description of an effect.
+ *
+ * @param effect the effect
+ * @return how the effect's particles are made
+ */
+const effect_def_t *emitter_effect_def(effect_t effect);
+
+/**
+ * Initializes an emitter in place. Nothing is emitted until the emitter is
+ * first updated.
+ *
+ * @param emitter the emitter to initialize
+ * @param effect the effect it emits
+ */
+void emitter_init(emitter_t *emitter, effect_t effect);
+
+/**
+ * Runs an emitter for a timestep, adding the particles that came due.
+ *
+ * @param emitter the emitter
+ * @param pool the pool to add particles to
+ * @param dt the timestep
+ * @param pos where the particles start
+ * @param vel the velocity of the thing emitting, part of which particles
+ *   carry along
+ * @param dir the unit direction particles are thrown in
+ */
+void emitter_update(emitter_t *emitter, particle_pool_t *pool, double dt,
+                    vector_t pos, vector_t vel, vector_t dir);
+
+/**
+ * Adds a one-off burst of an effect's particles.
+ *
+ * @param pool the pool to add particles to
+ * @param effect the effect to burst
+ * @param pos where the particles start
+ * @param dir the unit direction particles are thrown in
+ */
+void emitter_burst(particle_pool_t *pool, effect_t effect, vector_t pos,
+                   vector_t dir);
+
+#endif // #ifndef __EMITTER_H__
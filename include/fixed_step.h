@@ -0,0 +1,60 @@
+#ifndef __FIXED_STEP_H__
+#define __FIXED_STEP_H__
+
+#include <stddef.h>
+
+/**
+ * A fixed-timestep accumulator. Frames of any length feed time in, and the
+ * simulation is advanced in whole steps of a constant length, so physics
+ * behaves the same whatever the frame rate. The time left over between
+ * steps is exposed as an interpolation factor for rendering.
+ */
+typedef struct fixed_step fixed_step_t;
+
+/**
+ * Allocates memory for a fixed-timestep accumulator with no time banked.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param rate the number of simulation steps per second
+ * @param max_steps the most steps to run for a single frame. Time beyond
+ *   that is dropped, so a long stall slows the game down for a moment
+ *   rather than making every later frame try to catch up.
+ * @return the new accumulator
+ */
+fixed_step_t *fixed_step_init(double rate, size_t max_steps);
+
+/**
+ * Gets the length of one simulation step.
+ *
+ * @param stepper the accumulator
+ * @return the step length in seconds
+ */
+double fixed_step_dt(const fixed_step_t *stepper);
+
+/**
+ * Banks the time that a frame took and works out how many steps to run.
+ * The caller should tick the simulation that many times by fixed_step_dt().
+ *
+ * @param stepper the accumulator
+ * @param frame_dt the number of seconds since the last frame
+ * @return the number of steps to run this frame
+ */
+size_t fixed_step_advance(fixed_step_t *stepper, double frame_dt);
+
+/**
+ * Gets how far the current time lies between the last step and the next,
+ * for interpolating between the poses before and after the last step.
+ *
+ * @param stepper the accumulator
+ * @return a fraction in [0, 1)
+ */
+double fixed_step_alpha(const fixed_step_t *stepper);
+
+/**
+ * Releases memory allocated for an accumulator.
+ *
+ * @param stepper the accumulator to free
+ */
+void fixed_step_free(fixed_step_t *stepper);
+
+#endif // #ifndef __FIXED_STEP_H__
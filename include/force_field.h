@@ -0,0 +1,81 @@
+#ifndef __FORCE_FIELD_H__
+#define __FORCE_FIELD_H__
+
+#include "body.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A rectangular region of the world with an extra acceleration inside it,
+ * e.g. an updraft over a canyon.
+ */
+typedef struct {
+  aabb_t region;
+  vector_t accel;
+} field_zone_t;
+
+/**
+ * The accelerations a level applies to every moving body, independent of the
+ * bodies' masses:
+ * - the uniform pull of gravity plus the current wind,
+ * - quadratic air drag, -drag * |v| * v, and
+ * - any number of zones adding their own acceleration where they apply.
+ *
+ * Moving bodies are pointed at the field with body_set_accel_field() and
+ * force_field_accel() once, rather than being pushed by fresh forces every
+ * tick. The field is evaluated inside the bodies' integrators, so drag is
+ * resolved as accurately as the integrator allows and trajectory predictions
+ * that use the same field match the live simulation.
+ *
+ * Evaluation is per body: each body's integrator calls force_field_accel()
+ * once per stage, for that body alone. There is no batched pass over all
+ * bodies, so code that wants one has to loop over the bodies itself.
+ */
+typedef struct force_field {
+  vector_t gravity;
+  vector_t wind;
+  double drag;
+  field_zone_t *zones;
+  size_t num_zones;
+  size_t zone_capacity;
+} force_field_t;
+
+/**
+ * Allocates memory for a force field with no wind and no zones.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param gravity the acceleration due to gravity
+ * @param drag the quadratic drag coefficient, or 0 for no air
+ * @return the new force field
+ */
+force_field_t *force_field_init(vector_t gravity, double drag);
+
+/**
+ * Adds a zone with its own acceleration to a field.
+ *
+ * @param field the field to add to
+ * @param region the part of the world the zone covers
+ * @param accel the acceleration added to bodies whose centroid is inside it
+ */
+void force_field_add_zone(force_field_t *field, aabb_t region,
+                          vector_t accel);
+
+/**
+ * An accel_func_t giving a field's acceleration at a given state, for one
+ * body. The zones are tested one by one.
+ *
+ * @param pos the position of the body's centroid
+ * @param vel the body's velocity
+ * @param aux a pointer to the force_field_t
+ * @return the sum of the field's accelerations
+ */
+vector_t force_field_accel(vector_t pos, vector_t vel, void *aux);
+
+/**
+ * Releases memory allocated for a force field.
+ *
+ * @param field the field to free
+ */
+void force_field_free(force_field_t *field);
+
+#endif // #ifndef __FORCE_FIELD_H__
@@ -0,0 +1,132 @@
+#ifndef __HEIGHTFIELD_H__
+#define __HEIGHTFIELD_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * Terrain heights and surface normals sampled at evenly spaced x positions.
+ * Lookups between samples interpolate linearly; lookups outside the sampled
+ * range use the nearest end sample.
+ */
+typedef struct heightfield heightfield_t;
+
+/**
+ * A function giving the exact terrain height at an x position.
+ *
+ * @param x the x position to evaluate
+ * @param aux an auxiliary value passed to heightfield_init()
+ * @return the height of the terrain at x
+ */
+typedef double (*height_func_t)(double x, void *aux);
+
+/**
+ * Allocates a heightfield by sampling a height function every `dx` units
+ * from `min_x` up to and including `max_x`, and derives a unit normal at
+ * each sample from its neighbours.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param min_x the x position of the first sample
+ * @param max_x the x position the last sample must reach
+ * @param dx the spacing between samples
+ * @param height the function to sample
+ * @param aux an auxiliary value to pass to `height`
+ * @return the new heightfield
+ */
+heightfield_t *heightfield_init(double min_x, double max_x, double dx,
+                                height_func_t height, void *aux);
+
+/**
+ * Allocates a heightfield over samples that were baked ahead of time, e.g.
+ * ones mapped from a level file. The arrays are borrowed, not copied: they
+ * must outlive the heightfield, and heightfield_carve() writes into them.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param min_x the x position of the first sample
+ * @param dx the spacing between samples
+ * @param num_samples the number of samples; at least 2
+ * @param heights the height at each sample
+ * @param normals the unit normal at each sample
+ * @param max_height the largest of the heights
+ * @return the new heightfield
+ */
+heightfield_t *heightfield_wrap(double min_x, double dx, size_t num_samples,
+                                double *heights, vector_t *normals,
+                                double max_height);
+
+/**
+ * Exposes a heightfield's samples, e.g. so they can be saved.
+ *
+ * @param hf the heightfield to read
+ * @param min_x set to the x position of the first sample
+ * @param dx set to the spacing between samples
+ * @param num_samples set to the number of samples
+ * @param heights set to the array of heights
+ * @param normals set to the array of unit normals
+ */
+void heightfield_get_samples(const heightfield_t *hf, double *min_x,
+                             double *dx, size_t *num_samples,
+                             const double **heights,
+                             const vector_t **normals);
+
+/**
+ * Gets the interpolated terrain height at an x position.
+ *
+ * @param hf the heightfield to query
+ * @param x the x position to look up
+ * @return the height of the terrain at x
+ */
+double heightfield_height(const heightfield_t *hf, double x);
+
+/**
+ * Gets the interpolated unit normal of the terrain at an x position.
+ * The normal points out of the ground, i.e. has a positive y component.
+ *
+ * @param hf the heightfield to query
+ * @param x the x position to look up
+ * @return the terrain's surface normal at x
+ */
+vector_t heightfield_normal(const heightfield_t *hf, double x);
+
+/**
+ * Looks up the terrain height at many x positions at once.
+ * Equivalent to calling heightfield_height() on each position, but runs as
+ * one tight loop over the arrays.
+ *
+ * @param hf the heightfield to query
+ * @param xs the x positions to look up
+ * @param heights filled with the height at each position; may alias `xs`
+ * @param n the number of positions
+ */
+void heightfield_heights(const heightfield_t *hf, const double *xs,
+                         double *heights, size_t n);
+
+/**
+ * Lowers the terrain to the bottom of a circle, e.g. to carve a crater.
+ * Samples the circle does not cover are left alone, and the terrain is
+ * never raised. Only the rewritten samples and their neighbours' normals are
+ * touched, so the cost scales with the radius, not the heightfield's width.
+ * The maximum height is not lowered, so it stays an upper bound.
+ *
+ * @param hf the heightfield to carve
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ */
+void heightfield_carve(heightfield_t *hf, vector_t center, double radius);
+
+/**
+ * Gets the highest sampled point of the terrain.
+ *
+ * @param hf the heightfield to query
+ * @return the largest height in the heightfield
+ */
+double heightfield_max_height(const heightfield_t *hf);
+
+/**
+ * Releases memory allocated for a heightfield.
+ *
+ * @param hf the heightfield to free
+ */
+void heightfield_free(heightfield_t *hf);
+
+#endif // #ifndef __HEIGHTFIELD_H__
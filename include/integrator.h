@@ -0,0 +1,73 @@
+#ifndef __INTEGRATOR_H__
+#define __INTEGRATOR_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * The numerical methods available for advancing a point mass.
+ * All of them are exact for a constant acceleration except semi-implicit
+ * Euler, which lands a little short of the true path unless it substeps.
+ */
+typedef enum {
+  /** Updates velocity first, then moves at the new velocity. First order. */
+  INTEGRATOR_SEMI_IMPLICIT_EULER,
+  /** Moves with the current velocity and acceleration, then updates the
+   * velocity from the average of the old and new accelerations. Second
+   * order; what body_tick() has always done. */
+  INTEGRATOR_VELOCITY_VERLET,
+  /** Classic fourth-order Runge-Kutta. Four acceleration evaluations per
+   * step, worth it once the acceleration depends on velocity (e.g. drag). */
+  INTEGRATOR_RK4
+} integrator_t;
+
+/**
+ * A function giving the acceleration of a point mass in a given state.
+ *
+ * @param pos the position
+ * @param vel the velocity
+ * @param aux an auxiliary value passed to integrator_step()
+ * @return the acceleration
+ */
+typedef vector_t (*accel_func_t)(vector_t pos, vector_t vel, void *aux);
+
+/**
+ * An accel_func_t for a constant acceleration, such as gravity plus wind.
+ *
+ * @param aux a pointer to the vector_t acceleration
+ */
+vector_t integrator_constant_accel(vector_t pos, vector_t vel, void *aux);
+
+/**
+ * Advances a point mass by one step.
+ *
+ * @param method the integrator to use
+ * @param pos the position, updated in place
+ * @param vel the velocity, updated in place
+ * @param dt the length of the step
+ * @param accel gives the acceleration in each state the method samples
+ * @param aux an auxiliary value to pass to `accel`
+ */
+void integrator_step(integrator_t method, vector_t *pos, vector_t *vel,
+                     double dt, accel_func_t accel, void *aux);
+
+/**
+ * Advances a point mass by a time interval, split into equal substeps so
+ * that none moves it further than max_travel at its starting speed. Slow
+ * bodies take a single step; the number of substeps is capped so a runaway
+ * body cannot stall the tick.
+ *
+ * @param method the integrator to use
+ * @param pos the position, updated in place
+ * @param vel the velocity, updated in place
+ * @param dt the length of the whole interval
+ * @param max_travel the furthest a substep may move, or INFINITY to never
+ *   substep
+ * @param accel gives the acceleration in each state the method samples
+ * @param aux an auxiliary value to pass to `accel`
+ */
+void integrator_advance(integrator_t method, vector_t *pos, vector_t *vel,
+                        double dt, double max_travel, accel_func_t accel,
+                        void *aux);
+
+#endif // #ifndef __INTEGRATOR_H__
@@ -1,48 +1,147 @@
 #ifndef LEVEL_H
 #define LEVEL_H
 
+#include "body_set.h"
+#include "broad_phase.h"
+#include "force_field.h"
+#include "heightfield.h"
+#include "integrator.h"
+#include "level_file.h"
 #include "list.h"
+#include "particle.h"
 #include "scene.h"
 #include "vector.h"
 #include <stddef.h>
 
-typedef enum { FOREST, MESA, MOON, NONE } level_type_t;
-
 typedef struct {
+  // points into the level file, so only valid while the level is loaded
   const char *background_path;
   vector_t gravity;
   double max_wind;
+  double air_drag;
   color_t terrain_color;
   vector_t screen_min;
   vector_t screen_max;
   size_t turn_len;
-  level_type_t type;
 } level_info_t;
 
+/**
+ * A run of ground surface vertices that is built into a body while it is
+ * near the camera and freed once it leaves (see level_stream_ground()).
+ */
+typedef struct {
+  // index of the chunk's first surface vertex in the level file
+  size_t first;
+  size_t count;
+  // NULL while the chunk is not streamed in
+  body_t *body;
+} ground_chunk_t;
+
+/**
+ * How a level's bodies move. Each kind is kept in its own set, so a tick only
+ * visits the bodies that can change.
+ */
+typedef enum {
+  // infinite mass and at rest, e.g. players and crates. These are also in
+  // the level's scene, which owns them.
+  PARTITION_STATIC,
+  // infinite mass but moving: carried along at a constant velocity
+  PARTITION_KINEMATIC,
+  // finite mass: arrows, pushed by the force field
+  PARTITION_DYNAMIC,
+  NUM_PARTITIONS
+} partition_t;
+
 typedef struct level {
   level_info_t info;
+  level_file_t *file;
   scene_t *scene;
-  vector_t gravity;
-  vector_t wind;
+  // every body in the level, by how it moves; the level owns all but the
+  // static bodies
+  body_set_t *partitions[NUM_PARTITIONS];
+  // bodies the level has freed, by kind, for level_make_body() to reuse
+  body_set_t *spares[NUM_BODY_KINDS];
+  broad_phase_t *broad_phase;
+  // see contact_cache.h; not included here because it depends on this header
+  struct contact_cache *contacts;
+  // gravity, the current wind, and air drag, for every moving body
+  force_field_t *field;
   double max_wind;
+  // how arrows are integrated, both in flight and when predicting shots
+  integrator_t integrator;
+  double max_step_travel;
+  heightfield_t *ground;
+  // trail and impact particles; these are drawn only and are not bodies
+  particle_pool_t *particles;
+  // the ground is drawn from these chunks but collides via the heightfield,
+  // so it is kept out of the scene
+  ground_chunk_t *chunks;
+  size_t num_chunks;
+  // chunks in [live_first, live_end) have bodies
+  size_t live_first;
+  size_t live_end;
+  double max_ground_height;
 } level_t;
 
 /**
- * initialize a level
- * @param info the level_info_t describing a level
- * @return the intialized level
+ * initialize a level from a baked level file (see level_file.h). The file
+ * is mapped rather than parsed, and the terrain is read from it in place.
+ * No assets are created, so levels can also be simulated without a window.
+ * @param path the path of the level file
+ * @return the intialized level, or NULL if the file is missing, truncated,
+ *   or not a level file
+ */
+level_t *level_init(const char *path);
+
+/**
+ * add a body to the level, in the partition that fits how it moves: bodies
+ * with infinite mass are static if at rest and kinematic otherwise, and all
+ * others are dynamic. Static bodies are added to the level's scene, so a
+ * static body's index in the scene is scene_bodies() from just before the
+ * call. The level or its scene takes ownership of the body.
+ * @param level the level to add to
+ * @param body the body to add
+ */
+void level_add_body(level_t *level, body_t *body);
+
+/**
+ * make a body for a short-lived entity such as an arrow or a particle. The
+ * level keeps the bodies it frees, by kind, and reuses one of the same kind
+ * if it can, so once the level has warmed up, spawning and despawning cost
+ * no heap allocations. The body is not added to the level.
+ * @param level the level the body is for
+ * @param kind the kind of body
+ * @param shape the body's shape, which the body shares
+ * @param centroid the body's initial center of mass
+ * @param mass the body's mass
+ * @param color the body's color
+ *
+ * @return a body set up as by body_init_with_shape(), with its kind set
  */
-level_t *level_init(const level_info_t info);
+body_t *level_make_body(level_t *level, body_kind_t kind, shape_t *shape,
+                        vector_t centroid, double mass, color_t color);
 
 /**
- * updates bodies managed by a level via the physics engine
+ * check whether a body is still in a level, in any partition
+ * @param level the level to search
+ * @param body the body to look for; need not point to a live body
+ *
+ * @return whether the body is in the level
+ */
+bool level_has_body(level_t *level, const body_t *body);
+
+/**
+ * updates the moving bodies of a level via the physics engine. Only the
+ * kinematic and dynamic bodies are visited: dynamic bodies that leave the
+ * arena are removed, and arrows that hit the ground blow a crater into it.
  * @param level the level to update
  * @param dt the timestep to apply
  */
 void level_tick(level_t *level, double dt);
 
 /**
- * get the height of the ground at a given x point
+ * get the height of the ground at a given x point, interpolated from the
+ * heightfield baked into the level file
  * @param level the level whose ground to check
  * @param x_world x position in world coords
  *
@@ -51,14 +150,65 @@ void level_tick(level_t *level, double dt);
 double level_ground_height(level_t *level, double x_world);
 
 /**
- * frees all assets for a given level
- * @param level the level to free
+ * carve a round crater into the ground, lowering the heightfield and the
+ * mapped surface vertices, and rebuilding any streamed-in ground chunks
+ * under it. Only
+ * the part of the ground within radius of x is touched.
+ * @param level the level whose ground to carve
+ * @param x x position of the impact in world coords
+ * @param radius radius of the crater
  */
-void level_destroy(level_t *level);
+void level_carve_crater(level_t *level, double x, double radius);
+
+/**
+ * stream the ground in around a range of x positions: builds the bodies of
+ * the chunks overlapping the range and frees those of the chunks that have
+ * left it. Only the previously live chunks and the new range are visited,
+ * so the cost does not grow with the width of the arena.
+ * @param level the level whose ground to stream
+ * @param min_x left edge of the range in world coords
+ * @param max_x right edge of the range in world coords
+ */
+void level_stream_ground(level_t *level, double min_x, double max_x);
+
+/**
+ * draw the streamed-in ground chunks, skipping any outside the visible
+ * part of the world. Must be called after camera_apply().
+ * @param level the level whose ground to draw
+ */
+void level_render_ground(level_t *level);
+
+/**
+ * draw the level's kinematic and dynamic bodies, which are kept
+ * outside the scene. Must be called after camera_apply().
+ * @param level the level whose bodies to draw
+ */
+void level_render_bodies(level_t *level);
+
+/**
+ * get the unit normal of the ground at a given x point
+ * @param level the level whose ground to check
+ * @param x_world x position in world coords
+ *
+ * @return the ground's surface normal, pointing up out of the ground
+ */
+vector_t level_ground_normal(level_t *level, double x_world);
 
 /**
- * Exposes the ground's info string for effective comparison
+ * predict an arrow's flight through the level's force field, stepping it
+ * exactly as level_tick() would with the level's integrator
+ * @param level the level the arrow flies in
+ * @param pos the arrow's position, advanced in place
+ * @param vel the arrow's velocity, advanced in place
+ * @param dt how far ahead to predict
  */
-const char *get_ground_info();
+void level_predict_flight(level_t *level, vector_t *pos, vector_t *vel,
+                          double dt);
+
+/**
+ * frees all assets for a given level
+ * @param level the level to free
+ */
+void level_destroy(level_t *level);
 
 #endif // LEVEL_H
\ No newline at end of file
@@ -0,0 +1,122 @@
+#ifndef __LEVEL_FILE_H__
+#define __LEVEL_FILE_H__
+
+#include "color.h"
+#include "heightfield.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Baked arenas are stored as a fixed-size header followed by flat arrays.
+ * The header holds the byte offset and length of each array. Everything
+ * is stored in native byte order and 8-byte aligned, so a mapped file can be
+ * read in place without a parsing pass. Files are written by the level baker
+ * (demo/bake_levels.c).
+ */
+#define LEVEL_FILE_MAGIC 0x564c5241u // "ARLV"
+#define LEVEL_FILE_VERSION 2u
+
+enum { LEVEL_FILE_PATH_LEN = 64 };
+
+/**
+ * A horizontal range crates may spawn in. Crates sit on the ground.
+ */
+typedef struct {
+  double min_x;
+  double max_x;
+} level_zone_t;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  char background_path[LEVEL_FILE_PATH_LEN];
+  vector_t gravity;
+  double max_wind;
+  /** quadratic air drag coefficient (see force_field_t), 0 for none */
+  double air_drag;
+  color_t terrain_color;
+  vector_t screen_min;
+  vector_t screen_max;
+  uint64_t turn_len;
+
+  /** Terrain heights sampled every sample_dx units from sample_min_x */
+  double sample_min_x;
+  double sample_dx;
+  double max_height;
+  uint64_t num_samples;
+  /** double[num_samples] */
+  uint64_t heights_offset;
+  /** vector_t[num_samples], unit normals at each sample */
+  uint64_t normals_offset;
+
+  /** vector_t[num_ground_vertices], the ground's top surface, left to right */
+  uint64_t num_ground_vertices;
+  uint64_t ground_vertices_offset;
+
+  /** vector_t[num_spawns], ground positions players stand on */
+  uint64_t num_spawns;
+  uint64_t spawns_offset;
+
+  /** level_zone_t[num_crate_zones] */
+  uint64_t num_crate_zones;
+  uint64_t crate_zones_offset;
+} level_file_header_t;
+
+/**
+ * A level file mapped into memory. The arrays point straight into the
+ * mapping. The terrain samples and ground surface are mapped copy-on-write,
+ * so carving them changes only this mapping and never the file.
+ */
+typedef struct level_file {
+  void *data;
+  size_t size;
+  const level_file_header_t *header;
+  double *heights;
+  vector_t *normals;
+  vector_t *ground_vertices;
+  const vector_t *spawns;
+  const level_zone_t *crate_zones;
+} level_file_t;
+
+/**
+ * Maps a level file into memory. Only the header is checked; the arrays are
+ * paged in as they are first read.
+ *
+ * @param path the path of the level file
+ * @return the mapped level, or NULL if the file is missing or malformed
+ */
+level_file_t *level_file_open(const char *path);
+
+/**
+ * Unmaps a level file. Pointers into it become invalid.
+ *
+ * @param file the level file to close
+ */
+void level_file_close(level_file_t *file);
+
+/**
+ * Writes a level file. The magic, version, terrain sampling and all array
+ * counts and offsets in `header` are filled in from the other arguments;
+ * the remaining fields are written as given.
+ *
+ * @param path the path to write to
+ * @param header the level's settings
+ * @param ground the baked terrain heights and normals
+ * @param ground_vertices the ground's top surface, left to right
+ * @param num_ground_vertices the number of surface vertices
+ * @param spawns where players stand
+ * @param num_spawns the number of spawn points
+ * @param crate_zones where crates may spawn
+ * @param num_crate_zones the number of crate zones
+ * @return whether the file was written successfully
+ */
+bool level_file_write(const char *path, level_file_header_t header,
+                      const heightfield_t *ground,
+                      const vector_t *ground_vertices,
+                      size_t num_ground_vertices, const vector_t *spawns,
+                      size_t num_spawns, const level_zone_t *crate_zones,
+                      size_t num_crate_zones);
+
+#endif // #ifndef __LEVEL_FILE_H__
@@ -0,0 +1,63 @@
+#ifndef __MATCH_H__
+#define __MATCH_H__
+
+#include "arrow.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * One shot for the human side of a headless match.
+ */
+typedef struct {
+  /** launch angle in radians, counterclockwise from the +x axis */
+  double angle;
+  /** launch speed of the middle arrow */
+  double speed;
+  arrow_variant_t arrow;
+} scripted_shot_t;
+
+/**
+ * How to run a headless match.
+ */
+typedef struct {
+  /** the baked level file to play on */
+  const char *level_path;
+  /** seeds rand(), which drives the wind, crates, and the CPU's search */
+  unsigned int seed;
+  /** player one's shots, one per turn. Once they run out, player one lets
+   * the rest of their turns time out. */
+  const scripted_shot_t *shots;
+  size_t num_shots;
+  /** the length of one physics step */
+  double dt;
+  /** simulated seconds after which the match is called a draw */
+  double max_time;
+} match_config_t;
+
+typedef enum { MATCH_P1_WINS, MATCH_P2_WINS, MATCH_DRAW } match_outcome_t;
+
+/**
+ * What happened in a headless match.
+ */
+typedef struct {
+  match_outcome_t outcome;
+  int32_t hp[2];
+  /** the number of turns that ended */
+  size_t turns;
+  /** the number of physics steps simulated */
+  size_t steps;
+} match_result_t;
+
+/**
+ * Plays a whole match through level_tick() and turn_engine_update() without
+ * a window: no assets are created, nothing is drawn, and the simulation
+ * runs as fast as it can rather than in real time. The same config always
+ * plays out the same way.
+ *
+ * @param config the match to play; its level file must load (see
+ *   level_init())
+ * @return how the match ended
+ */
+match_result_t match_run(const match_config_t *config);
+
+#endif // #ifndef __MATCH_H__
@@ -0,0 +1,137 @@
+#ifndef __PARTICLE_H__
+#define __PARTICLE_H__
+
+#include "color.h"
+#include "heightfield.h"
+#include "vector.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A ring buffer of purely visual particles, e.g. arrow trails and the dust
+ * thrown up by impacts. Particles are not bodies: they never collide with
+ * each other or with bodies, only come to rest on the ground. See emitter.h
+ * for how particles are made.
+ *
+ * Each attribute is kept in its own array (structure of arrays), indexed by
+ * slot. The particles occupy the `count` slots starting at `head`, wrapping
+ * around the end of the arrays, oldest first; use particle_pool_slot() to
+ * walk them. A particle that dies before older ones stays in its slot, with
+ * no lifetime left, until the older ones have died too.
+ *
+ * Positions and velocities are single precision, since particles only need
+ * to land on the right pixel, so the update loop moves half as much memory
+ * and can be vectorized.
+ */
+typedef struct particle_pool {
+  size_t head;
+  size_t count;
+  size_t capacity;
+  // the capacity the pool may grow to; once it is reached, each new
+  // particle replaces the oldest
+  size_t budget;
+  float *x;
+  float *y;
+  float *vx;
+  float *vy;
+  // seconds left to live, and how long the particle lived in total
+  float *lifetime;
+  float *max_lifetime;
+  // the width of the square the particle is drawn as, in pixels
+  float *size;
+  // how strongly gravity and wind pull on the particle; particles that are
+  // pulled at all also rest on the ground rather than falling through it
+  float *weight;
+  // the particle's color packed by particle_pack_color()
+  uint32_t *rgba;
+  // state of particle_pool_random()
+  uint64_t random_state;
+} particle_pool_t;
+
+/**
+ * Allocates an empty particle pool.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param capacity how many particles to make room for up front
+ * @param budget the most particles the pool may ever hold; at least
+ *   `capacity`
+ * @return the new pool
+ */
+particle_pool_t *particle_pool_init(size_t capacity, size_t budget);
+
+/**
+ * Adds a particle to a pool. If the pool is full, it grows, or replaces its
+ * oldest particle once it has reached its budget.
+ * Asserts that any required memory is successfully allocated.
+ *
+ * @param pool the pool to add to
+ * @param pos where the particle starts
+ * @param vel the particle's initial velocity
+ * @param lifetime how many seconds the particle lives for; must be positive
+ * @param size the width of the particle, in pixels
+ * @param weight how strongly the pool's acceleration pulls on the particle
+ * @param color the particle's color
+ */
+void particle_pool_emit(particle_pool_t *pool, vector_t pos, vector_t vel,
+                        double lifetime, double size, double weight,
+                        color_t color);
+
+/**
+ * Gets the slot of one of a pool's particles.
+ *
+ * @param pool the pool
+ * @param i the particle's age rank, from 0 (the oldest) up to `count`
+ * @return the index of the particle in the pool's arrays
+ */
+size_t particle_pool_slot(const particle_pool_t *pool, size_t i);
+
+/**
+ * Draws a random number for an effect. Effects have their own generator,
+ * kept apart from rand(), so spawning them never changes how a match plays
+ * out.
+ *
+ * @param pool the pool whose generator to draw from
+ * @param min the smallest number to return
+ * @param max the number all results are below
+ * @return a uniformly distributed number in [min, max)
+ */
+double particle_pool_random(particle_pool_t *pool, double min, double max);
+
+/**
+ * Advances every particle in a pool by one timestep: ages it, accelerates
+ * it by its share of `accel`, moves it, and stops it on the ground if it has
+ * weight and has fallen into the terrain. The oldest particles are dropped
+ * once their lifetime has run out.
+ *
+ * @param pool the pool to update
+ * @param dt the timestep
+ * @param accel the acceleration applied to particles of weight 1
+ * @param ground the terrain particles come to rest on
+ */
+void particle_pool_update(particle_pool_t *pool, double dt, vector_t accel,
+                          const heightfield_t *ground);
+
+/**
+ * Removes every particle from a pool.
+ *
+ * @param pool the pool to clear
+ */
+void particle_pool_clear(particle_pool_t *pool);
+
+/**
+ * Releases memory allocated for a pool.
+ *
+ * @param pool the pool to free
+ */
+void particle_pool_free(particle_pool_t *pool);
+
+/**
+ * Packs a color into 8-bit red, green, blue and alpha channels, red in the
+ * most significant byte. Alpha is fully opaque.
+ *
+ * @param color the color to pack, with each channel between 0 and 1
+ * @return the packed color
+ */
+uint32_t particle_pack_color(color_t color);
+
+#endif // #ifndef __PARTICLE_H__
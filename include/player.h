@@ -0,0 +1,28 @@
+#ifndef __PLAYER_H__
+#define __PLAYER_H__
+
+#include "body.h"
+#include "color.h"
+#include "turn_engine.h"
+#include "vector.h"
+
+/**
+ * Builds a player's body standing on a spawn point. The body is of kind
+ * BODY_PLAYER and carries the player's `int32_t` HP as its info. No sprite
+ * is attached, so the body can be simulated without a renderer.
+ *
+ * @param id which player the body is for
+ * @param spawn the point on the ground the player stands on
+ * @return the player's body, to be added to the level's scene
+ */
+body_t *player_init(player_id_t id, vector_t spawn);
+
+/**
+ * Gets the color a player is drawn and labelled in.
+ *
+ * @param id the player
+ * @return the player's color
+ */
+color_t player_color(player_id_t id);
+
+#endif // #ifndef __PLAYER_H__
@@ -0,0 +1,151 @@
+#ifndef __POLYGON_H__
+#define __POLYGON_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+enum {
+  /** Polygons with at most this many vertices are stored inline */
+  POLYGON_INLINE_CAPACITY = 8
+};
+
+/**
+ * A polygon's vertices, along with the outward unit normal of each edge.
+ * Normal i belongs to the edge from vertex i to vertex i + 1 (wrapping
+ * around), assuming the vertices are in counterclockwise order.
+ *
+ * Each coordinate is kept in its own array (structure of arrays), so placing
+ * a polygon and projecting it onto an axis are straight passes over plain
+ * doubles; see the vec_batch_*() functions.
+ *
+ * Polygons of up to POLYGON_INLINE_CAPACITY vertices (every arrow, crate
+ * and player) are kept inside the struct itself, so they need no allocation
+ * of their own; larger ones spill onto the heap. Use polygon_xs() and its
+ * siblings rather than the fields, which depend on where the polygon is
+ * stored.
+ */
+typedef struct {
+  size_t num_vertices;
+  // the most vertices the polygon can hold without growing
+  size_t capacity;
+  // 4 * capacity doubles, laid out like inline_coords, or NULL while inline
+  double *heap;
+  // the vertices' xs, their ys, the normals' xs and their ys, each
+  // POLYGON_INLINE_CAPACITY long
+  double inline_coords[4 * POLYGON_INLINE_CAPACITY];
+} polygon_t;
+
+/**
+ * Initializes an empty polygon in place, with room for
+ * POLYGON_INLINE_CAPACITY vertices.
+ *
+ * @param polygon the polygon to initialize
+ */
+void polygon_init(polygon_t *polygon);
+
+/**
+ * Sets a polygon's vertices, copying them in and computing the edge normals.
+ * Only allocates if the polygon has never held as many vertices before.
+ * Asserts that any required memory is successfully allocated.
+ *
+ * @param polygon an initialized polygon
+ * @param vertices the new vertices, in counterclockwise order
+ * @param n the number of vertices
+ */
+void polygon_set(polygon_t *polygon, const vector_t *vertices, size_t n);
+
+/**
+ * Sets a polygon to another polygon rotated about the origin and then
+ * translated, i.e. placed at a pose. The normals are rotated rather than
+ * recomputed. Only allocates if the polygon has never held as many vertices
+ * before.
+ *
+ * @param polygon an initialized polygon to write to; must not be `source`
+ * @param source the polygon to place
+ * @param translation where to move the source's origin to
+ * @param cos_angle the cosine of the rotation angle
+ * @param sin_angle the sine of the rotation angle
+ */
+void polygon_transform(polygon_t *polygon, const polygon_t *source,
+                       vector_t translation, double cos_angle,
+                       double sin_angle);
+
+/**
+ * Gets the x coordinates of a polygon's vertices.
+ *
+ * @param polygon the polygon
+ * @return a pointer to its num_vertices contiguous x coordinates
+ */
+const double *polygon_xs(const polygon_t *polygon);
+
+/**
+ * Gets the y coordinates of a polygon's vertices.
+ *
+ * @param polygon the polygon
+ * @return a pointer to its num_vertices contiguous y coordinates
+ */
+const double *polygon_ys(const polygon_t *polygon);
+
+/**
+ * Gets the x components of the outward unit normals of a polygon's edges.
+ * Zero-length edges have a zero normal.
+ *
+ * @param polygon the polygon
+ * @return a pointer to its num_vertices contiguous x components
+ */
+const double *polygon_normal_xs(const polygon_t *polygon);
+
+/**
+ * Gets the y components of the outward unit normals of a polygon's edges.
+ *
+ * @param polygon the polygon
+ * @return a pointer to its num_vertices contiguous y components
+ */
+const double *polygon_normal_ys(const polygon_t *polygon);
+
+/**
+ * Gets one of a polygon's vertices.
+ *
+ * @param polygon the polygon
+ * @param i the index of the vertex; less than num_vertices
+ * @return the vertex
+ */
+vector_t polygon_vertex(const polygon_t *polygon, size_t i);
+
+/**
+ * Gets the outward unit normal of one of a polygon's edges.
+ *
+ * @param polygon the polygon
+ * @param i the index of the edge; less than num_vertices
+ * @return the normal of the edge from vertex i to vertex i + 1
+ */
+vector_t polygon_normal(const polygon_t *polygon, size_t i);
+
+/**
+ * Computes the signed area of a polygon with the shoelace formula.
+ * Counterclockwise polygons have positive area.
+ * See https://en.wikipedia.org/wiki/Shoelace_formula#Statement.
+ *
+ * @param polygon the polygon
+ * @return the signed area of the polygon
+ */
+double polygon_signed_area(const polygon_t *polygon);
+
+/**
+ * Computes the centroid of a polygon.
+ * See https://en.wikipedia.org/wiki/Centroid#Of_a_polygon.
+ *
+ * @param polygon the polygon
+ * @return the centroid of the polygon
+ */
+vector_t polygon_centroid(const polygon_t *polygon);
+
+/**
+ * Releases any memory a polygon allocated. The polygon itself is not freed,
+ * and may be used again after polygon_init().
+ *
+ * @param polygon the polygon to clean up
+ */
+void polygon_free(polygon_t *polygon);
+
+#endif // #ifndef __POLYGON_H__
@@ -71,12 +71,26 @@ bool sdl_is_done(state_t *state);
 void sdl_clear(void);
 
 /**
- * Draws a body using the color of the body.
+ * Adds a body to the batch (see sdl_batch_flush()), filled with the color of
+ * the body. The body must be convex, as every body that collides is.
  *
  * @param body the body struct to draw
  */
 void sdl_draw_body(body_t *body);
 
+/**
+ * Adds the ground below a surface, down to a given height, to the batch (see
+ * sdl_batch_flush()). The surface's x coordinates must never decrease, as a
+ * heightfield's outline's do, so the ground under each edge is a trapezoid.
+ *
+ * @param surface the surface's vertices, from left to right
+ * @param n the number of vertices; at least 2
+ * @param bottom the y coordinate the ground extends down to
+ * @param ground_color the ground's color
+ */
+void sdl_draw_ground(const vector_t *surface, size_t n, double bottom,
+                     color_t ground_color);
+
 /**
  * Loads an image from a file and returns it as an SDL texture.
  *
@@ -122,14 +136,24 @@ void sdl_render_image(SDL_Texture *image_texture, SDL_Rect *rect);
 void sdl_show(void);
 
 /**
- * Draws all bodies in a scene.
- * This internally calls sdl_clear(), sdl_draw_body(), and sdl_show(),
- * so those functions should not be called directly.
+ * Draws the bodies in a scene that are on the RENDER_SHAPE render layer.
+ * Bodies whose cached bounding boxes lie outside the part of the scene
+ * currently shown (see camera_apply()) are skipped without touching their
+ * vertices.
  *
  * @param scene the scene to draw
  */
 void sdl_render_scene(scene_t *scene);
 
+/**
+ * Draws an array of bodies the same way as sdl_render_scene(), for bodies
+ * that are kept outside the scene, such as a level's arrows.
+ *
+ * @param bodies the bodies to draw
+ * @param n the number of bodies
+ */
+void sdl_render_bodies(body_t *const *bodies, size_t n);
+
 /**
  * Registers a function to be called every time a key is pressed.
  * Overwrites any existing handler.
@@ -166,15 +190,26 @@ void sdl_on_key(key_handler_t handler);
 void sdl_on_mouse(mouse_handler_t handler);
 
 /**
- * Gets the amount of time that has passed since the last time
- * this function was called, in seconds.
+ * Gets the amount of wall-clock time that has passed since the last time
+ * this function was called, in seconds, from a monotonic clock.
  *
  * @return the number of seconds that have elapsed
  */
 double time_since_last_tick(void);
 
 /**
- * Finds the bounding box for a given body
+ * Sets how far between the last two simulation steps bodies are drawn.
+ * sdl_draw_body() and sdl_get_body_bounding_box() place each body at
+ * body_get_interpolated_centroid() with this factor.
+ *
+ * @param alpha 0 to draw bodies where they were before the last step,
+ *   1 to draw them where they are now
+ */
+void sdl_set_interpolation(double alpha);
+
+/**
+ * Finds the bounding box for a given body in window coordinates, from the
+ * body's cached world-space bounding box
  *
  * @param body the body whose bounding box is to be computed
  *
@@ -183,6 +218,16 @@ double time_since_last_tick(void);
 
 SDL_Rect sdl_get_body_bounding_box(body_t *body);
 
+/**
+ * Finds the region of the render target, in the coords produced by
+ * get_window_position, that lands inside the window under the renderer's
+ * current viewport and scale (see camera_apply). Bodies whose bounding boxes
+ * miss it can be skipped when drawing.
+ *
+ * @return the visible region
+ */
+SDL_Rect get_visible_rect(void);
+
 /**
  * Maps a scene coordinate to a window coordinate
  * @param scene_pos position in scene
@@ -215,7 +260,7 @@ vector_t get_window_center();
 SDL_Renderer *sdl_get_renderer();
 
 /**
- * Draw and render a dot.
+ * Draw a dot, batched with sdl_batch_circle().
  * @param x x position (SDL coords)
  * @param y y position (SDL coords)
  * @param r radius of the dot to be draw
@@ -223,4 +268,60 @@ SDL_Renderer *sdl_get_renderer();
  */
 void draw_dot(int x, int y, int r, SDL_Color color);
 
+/*
+ * Batched primitives. Instead of one SDL draw call each, primitives are
+ * collected into triangle lists, each vertex carrying the primitive's color,
+ * and drawn by sdl_batch_flush() with one SDL_RenderGeometry() call per
+ * blend mode: opaque primitives without blending, and the rest, e.g. fading
+ * particles, alpha blended. All coordinates are in pixels (SDL coords).
+ *
+ * Primitives are drawn when flushed, so flush before drawing anything that
+ * must appear on top of them, and before changing the renderer's viewport or
+ * scale. sdl_show() flushes whatever is left.
+ */
+
+/**
+ * Adds a one-pixel point to the batch.
+ * @param x x position
+ * @param y y position
+ * @param color color of the point
+ */
+void sdl_batch_point(double x, double y, SDL_Color color);
+
+/**
+ * Adds a filled axis-aligned rectangle to the batch.
+ * @param x x position of the left edge
+ * @param y y position of the top edge
+ * @param w width of the rectangle
+ * @param h height of the rectangle
+ * @param color color of the rectangle
+ */
+void sdl_batch_rect(double x, double y, double w, double h, SDL_Color color);
+
+/**
+ * Adds a one-pixel-wide line to the batch.
+ * @param x1 x position of one end
+ * @param y1 y position of one end
+ * @param x2 x position of the other end
+ * @param y2 y position of the other end
+ * @param color color of the line
+ */
+void sdl_batch_line(double x1, double y1, double x2, double y2,
+                    SDL_Color color);
+
+/**
+ * Adds a filled circle to the batch. Its outline is a polygon with more
+ * sides the bigger the circle is.
+ * @param x x position of the center
+ * @param y y position of the center
+ * @param r radius of the circle
+ * @param color color of the circle
+ */
+void sdl_batch_circle(double x, double y, double r, SDL_Color color);
+
+/**
+ * Draws every batched primitive and empties the batch.
+ */
+void sdl_batch_flush(void);
+
 #endif // #ifndef __SDL_WRAPPER_H__
\ No newline at end of file
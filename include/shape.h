@@ -0,0 +1,63 @@
+#ifndef __SHAPE_H__
+#define __SHAPE_H__
+
+#include "polygon.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * An immutable polygon in local coordinates, with its centroid at the
+ * origin. Bodies place a shape in the world with their own position and
+ * rotation, so every body with the same outline (every particle, every arrow
+ * of a variant, every crate) can share one shape.
+ * Shapes are reference counted: each body holds a reference to its shape.
+ */
+typedef struct shape shape_t;
+
+/**
+ * Allocates memory for a shape from a polygon, which is copied and moved so
+ * that its centroid lies at the origin. The caller holds the only reference.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param vertices the polygon's vertices, in any frame
+ * @param n the number of vertices
+ * @param centroid if non-NULL, set to the polygon's centroid in the frame
+ *   of `vertices`, i.e. where a body must be put to cover the polygon
+ * @return the new shape
+ */
+shape_t *shape_init(const vector_t *vertices, size_t n, vector_t *centroid);
+
+/**
+ * Takes another reference to a shape.
+ *
+ * @param shape the shape to share
+ * @return `shape`
+ */
+shape_t *shape_retain(shape_t *shape);
+
+/**
+ * Drops a reference to a shape, freeing it once no references are left.
+ *
+ * @param shape the shape to release
+ */
+void shape_release(shape_t *shape);
+
+/**
+ * Gets the outline of a shape relative to its centroid, without copying it.
+ * The polygon lives as long as the shape and must not be modified.
+ *
+ * @param shape the shape
+ * @return the shape's polygon
+ */
+const polygon_t *shape_get_polygon(const shape_t *shape);
+
+/**
+ * Returns the area of a shape.
+ * See https://en.wikipedia.org/wiki/Shoelace_formula#Statement.
+ *
+ * @param shape the shape
+ * @return the shape's area
+ */
+double shape_area(const shape_t *shape);
+
+#endif // #ifndef __SHAPE_H__
@@ -32,6 +32,16 @@ void shoot_drag(turn_engine_t *eng, double mouse_x, double mouse_y);
 void shoot_end(turn_engine_t *eng, body_t *shooter, double mouse_x,
                double mouse_y);
 
+/**
+ * Fires the equipped arrow (or, for multishot, a spread of arrows) and
+ * registers it with the turn engine. Used by shoot_end() and by scripted
+ * shots in headless matches.
+ * @param eng current turn engine
+ * @param shooter body the arrow is to be shot from
+ * @param vel the launch velocity of the middle arrow
+ */
+void shoot_fire(turn_engine_t *eng, body_t *shooter, vector_t vel);
+
 /**
  * Render prospective shot path
  * @param cam current camera
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 
 #include "camera.h"
+#include "fixed_step.h"
 #include "level.h"
 #include "math.h"
 #include "turn_engine.h"
@@ -27,19 +28,24 @@ typedef struct state {
   turn_engine_t *eng;
   overlay_t overlay;
   size_t level_num;
-  level_info_t level_info[];
+  // turns frame times into fixed-length simulation steps
+  fixed_step_t *stepper;
+  const char *level_paths[];
 } state_t;
 
 /**
  * Returns an initialized state variable that handles
  * the engine, level, camera, and any thing that
  * needs to be rendered on the screen
- * @param levels level info of all possible levels
- * @param num_levels number of levels in "levels"
+ * @param level_paths paths of the baked level files of all possible levels
+ * @param num_levels number of levels in "level_paths"
+ * @param sim_rate the number of physics steps to simulate per second
+ * @param max_steps the most physics steps to run per frame when catching up
  *
  * @return a fully initialized state_t
  */
-state_t *state_init(const level_info_t levels[], size_t num_levels);
+state_t *state_init(const char *level_paths[], size_t num_levels,
+                    double sim_rate, size_t max_steps);
 
 /**
  * free state and all of its constituent variables
@@ -51,8 +57,12 @@ void state_free(state_t *state);
  * Run all necessary updates. Renders necessary objects,
  * checks game end, move things as needed, adjust health, etc.abort
  *
+ * During play, the frame time is banked and the level is advanced in fixed
+ * steps of 1 / sim_rate seconds, with bodies drawn interpolated between
+ * the last two steps.
+ *
  * @param state current state object
- * @param dt timestep for update
+ * @param dt seconds since the last frame
  */
 void state_tick(state_t *state, double dt);
 
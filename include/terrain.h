@@ -0,0 +1,37 @@
+#ifndef __TERRAIN_H__
+#define __TERRAIN_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * The procedural terrain generators the built-in arenas are baked from.
+ * Only the level baker uses these; the game reads the baked level files.
+ */
+typedef enum { FOREST, MESA, MOON, NONE } level_type_t;
+
+/**
+ * Evaluates the exact height of a terrain type.
+ *
+ * @param type the terrain generator to use
+ * @param x the x position in world coordinates
+ * @param w the width of the arena
+ * @return the height of the terrain at x
+ */
+double terrain_height(level_type_t type, double x, double w);
+
+/**
+ * Builds the top surface of a terrain type as a polyline running from the
+ * left edge of the arena to the right edge, sorted by x. The two end points
+ * sit at the arena's base height.
+ *
+ * @param type the terrain generator to use
+ * @param screen_min the bottom left corner of the arena
+ * @param screen_max the top right corner of the arena
+ * @param num_vertices set to the number of vertices returned
+ * @return a newly allocated array of vertices, which must be free()d
+ */
+vector_t *terrain_surface(level_type_t type, vector_t screen_min,
+                          vector_t screen_max, size_t *num_vertices);
+
+#endif // #ifndef __TERRAIN_H__
@@ -5,12 +5,26 @@
 #include "camera.h"
 #include "input.h"
 #include "level.h"
+#include "worker_pool.h"
 #include <stdint.h>
 
 typedef enum { CAM_PLAYER, CAM_ARROW } cam_mode_t;
 
 typedef enum { PLAYER_ONE, PLAYER_TWO } player_id_t;
 
+/**
+ * How far the CPU's search for its shot has got.
+ */
+typedef enum {
+  /** Trying the speed and aim of the CPU's previous shot */
+  CPU_SEARCH_WARM,
+  /** Trying speeds from slowest to fastest until one hits */
+  CPU_SEARCH_GRID,
+  /** Nothing hit: narrowing in on the speed of the closest miss */
+  CPU_SEARCH_REFINE,
+  CPU_SEARCH_DONE
+} cpu_search_phase_t;
+
 typedef struct turn_engine {
   level_t *level;
   camera_t *cam;
@@ -22,10 +36,25 @@ typedef struct turn_engine {
   size_t p_body_idx[2];
   body_t *tracked_arrow;
   bool cpu_pending;
-  size_t cpu_sample_idx;
+  cpu_search_phase_t cpu_phase;
+  // the next grid speed to try, or how many refinement steps are done
+  size_t cpu_step;
+  // the best shot so far: its squared miss distance, launch, and how far
+  // from the target it aimed to make up for drag
   double cpu_best_err;
   double cpu_best_angle;
   double cpu_best_speed;
+  vector_t cpu_best_offset;
+  // the CPU's previous shot, if it had one that could reach
+  bool cpu_warm;
+  double cpu_warm_speed;
+  vector_t cpu_warm_offset;
+  // searches for the CPU's shot
+  worker_pool_t *cpu_workers;
+  // performance counter ticks the search has spent in the current frame,
+  // and whether it has run a batch in it yet (see turn_engine_begin_frame())
+  uint64_t frame_search_ticks;
+  bool frame_searched;
   arrow_variant_t equipped_arrow;
   double burst_animation_time;
 } turn_engine_t;
@@ -34,7 +63,9 @@ typedef struct turn_engine {
  * initializes the turn engine
  *
  * @param level the current level
- * @param cam camera object
+ * @param cam camera object, or NULL to run headless: the camera is left
+ *   alone, crates get no sprites, and neither the CPU's thinking pause nor
+ *   the impact animation hold up the match
  * @param turn_len_sec maximum amount of time a player can take before shooting
  * @param p1_body_idx index of the main player's body
  * @param p2_body_dx index of AI's body
@@ -45,6 +76,14 @@ turn_engine_t *turn_engine_init(level_t *level, camera_t *cam,
                                 double turn_len_sec, size_t p1_body_idx,
                                 size_t p2_body_idx);
 
+/**
+ * Starts a new frame's CPU search budget. Call once per rendered frame,
+ * before the frame's turn_engine_update() steps, which then share the
+ * budget between them.
+ * @param eng current turn engine object
+ */
+void turn_engine_begin_frame(turn_engine_t *eng);
+
 /**
  * updates the turn engine, checking if an arrow has been shot and
  * subsequently removed
@@ -1,6 +1,9 @@
 #ifndef __VECTOR_H__
 #define __VECTOR_H__
 
+#include <math.h>
+#include <stddef.h>
+
 /**
  * A real-valued 2-dimensional vector.
  * Positive x is towards the right; positive y is towards the top.
@@ -14,10 +17,17 @@ typedef struct {
 /**
  * The zero vector, i.e. (0, 0).
  * "extern" declares this global variable without allocating memory for it.
- * You will need to define "const vector_t VEC_ZERO = ..." in vector.c.
+ * It is defined in vector.c.
  */
 extern const vector_t VEC_ZERO;
 
+/*
+ * The scalar operations below are defined here as C99 inline functions, so
+ * they can be inlined into the hot loops that call them. vector.c emits the
+ * one out-of-line copy of each, for code that takes their address or was
+ * compiled without inlining.
+ */
+
 /**
  * Adds two vectors.
  * Performs the usual componentwise vector sum.
@@ -26,7 +36,9 @@ extern const vector_t VEC_ZERO;
  * @param v2 the second vector
  * @return v1 + v2
  */
-vector_t vec_add(vector_t v1, vector_t v2);
+inline vector_t vec_add(vector_t v1, vector_t v2) {
+  return (vector_t){v1.x + v2.x, v1.y + v2.y};
+}
 
 /**
  * Subtracts two vectors.
@@ -36,7 +48,9 @@ vector_t vec_add(vector_t v1, vector_t v2);
  * @param v2 the second vector
  * @return v1 - v2
  */
-vector_t vec_subtract(vector_t v1, vector_t v2);
+inline vector_t vec_subtract(vector_t v1, vector_t v2) {
+  return (vector_t){v1.x - v2.x, v1.y - v2.y};
+}
 
 /**
  * Computes the additive inverse a vector.
@@ -45,7 +59,7 @@ vector_t vec_subtract(vector_t v1, vector_t v2);
  * @param v the vector whose inverse to compute
  * @return -v
  */
-vector_t vec_negate(vector_t v);
+inline vector_t vec_negate(vector_t v) { return (vector_t){-v.x, -v.y}; }
 
 /**
  * Multiplies a vector by a scalar.
@@ -55,7 +69,9 @@ vector_t vec_negate(vector_t v);
  * @param v the vector to scale
  * @return scalar * v
  */
-vector_t vec_multiply(double scalar, vector_t v);
+inline vector_t vec_multiply(double scalar, vector_t v) {
+  return (vector_t){scalar * v.x, scalar * v.y};
+}
 
 /**
  * Computes the dot product of two vectors.
@@ -65,7 +81,9 @@ vector_t vec_multiply(double scalar, vector_t v);
  * @param v2 the second vector
  * @return v1 . v2
  */
-double vec_dot(vector_t v1, vector_t v2);
+inline double vec_dot(vector_t v1, vector_t v2) {
+  return v1.x * v2.x + v1.y * v2.y;
+}
 
 /**
  * Computes the cross product of two vectors,
@@ -76,7 +94,9 @@ double vec_dot(vector_t v1, vector_t v2);
  * @param v2 the second vector
  * @return the z-component of v1 x v2
  */
-double vec_cross(vector_t v1, vector_t v2);
+inline double vec_cross(vector_t v1, vector_t v2) {
+  return v1.x * v2.y - v1.y * v2.x;
+}
 
 /**
  * Rotates a vector by an angle around (0, 0).
@@ -90,7 +110,11 @@ double vec_cross(vector_t v1, vector_t v2);
  * @param angle the angle to rotate the vector
  * @return v rotated by the given angle
  */
-vector_t vec_rotate(vector_t v, double angle);
+inline vector_t vec_rotate(vector_t v, double angle) {
+  double c = cos(angle);
+  double s = sin(angle);
+  return (vector_t){v.x * c - v.y * s, v.x * s + v.y * c};
+}
 
 /**
  * Calculate the length of a vector.
@@ -98,6 +122,75 @@ vector_t vec_rotate(vector_t v, double angle);
  * @param v the vector to calculate the length of
  * @return a double representing the vector's magnitude
  */
-double vec_get_length(vector_t v);
+inline double vec_get_length(vector_t v) {
+  return sqrt(v.x * v.x + v.y * v.y);
+}
+
+/*
+ * Batched operations over points stored as separate x and y arrays
+ * (structure of arrays). Each loop is a straight pass over plain doubles, so
+ * the compiler can vectorize it. The coordinate arrays must not overlap one
+ * another.
+ */
+
+/**
+ * Adds the same offset to n points.
+ *
+ * @param xs the points' x coordinates, updated in place
+ * @param ys the points' y coordinates, updated in place
+ * @param n the number of points
+ * @param offset the vector to add to each point
+ */
+void vec_batch_translate(double *xs, double *ys, size_t n, vector_t offset);
+
+/**
+ * Adds a scaled vector to each of n points, pointwise:
+ * (xs[i], ys[i]) += scalar * (dxs[i], dys[i]).
+ * With a scalar of 1 this is a plain batched vec_add().
+ *
+ * @param xs the points' x coordinates, updated in place
+ * @param ys the points' y coordinates, updated in place
+ * @param dxs the x components of the vectors to add
+ * @param dys the y components of the vectors to add
+ * @param scalar the number to multiply each added vector by
+ * @param n the number of points
+ */
+void vec_batch_add_scaled(double *xs, double *ys, const double *dxs,
+                          const double *dys, double scalar, size_t n);
+
+/**
+ * Multiplies n points by a scalar.
+ *
+ * @param xs the points' x coordinates, updated in place
+ * @param ys the points' y coordinates, updated in place
+ * @param n the number of points
+ * @param scalar the number to multiply each point by
+ */
+void vec_batch_scale(double *xs, double *ys, size_t n, double scalar);
+
+/**
+ * Rotates n points around (0, 0). Takes the cosine and sine of the angle
+ * rather than the angle, so they are computed once per batch.
+ *
+ * @param xs the points' x coordinates, updated in place
+ * @param ys the points' y coordinates, updated in place
+ * @param n the number of points
+ * @param cos_angle the cosine of the rotation angle
+ * @param sin_angle the sine of the rotation angle
+ */
+void vec_batch_rotate(double *xs, double *ys, size_t n, double cos_angle,
+                      double sin_angle);
+
+/**
+ * Computes the dot product of each of n points with the same vector.
+ *
+ * @param xs the points' x coordinates
+ * @param ys the points' y coordinates
+ * @param n the number of points
+ * @param v the vector to dot each point with
+ * @param out set to the n dot products
+ */
+void vec_batch_dot(const double *xs, const double *ys, size_t n, vector_t v,
+                   double *out);
 
 #endif // #ifndef __VECTOR_H__
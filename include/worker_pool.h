@@ -0,0 +1,65 @@
+#ifndef __WORKER_POOL_H__
+#define __WORKER_POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A fixed set of threads that run the indices of a task in parallel. The
+ * thread that starts a task works on it too, and waits for it to finish, so
+ * a pool with no threads simply runs the task in a loop.
+ *
+ * Indices are handed out in whatever order threads come free, so a task
+ * whose result must not depend on the number of threads should make each
+ * index's work depend only on the index, and write its result to a slot of
+ * its own.
+ */
+typedef struct worker_pool worker_pool_t;
+
+/**
+ * A function run once for each index of a task.
+ *
+ * @param index the index to work on
+ * @param aux an auxiliary value passed to worker_pool_run()
+ */
+typedef void (*worker_task_t)(size_t index, void *aux);
+
+/**
+ * Allocates a worker pool and starts its threads. Threads that cannot be
+ * started, e.g. in a build without thread support, are left out, and the
+ * pool works with the rest.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param num_threads how many threads to start besides the caller's
+ * @return the new worker pool
+ */
+worker_pool_t *worker_pool_init(size_t num_threads);
+
+/**
+ * Gets the number of threads a pool actually started.
+ *
+ * @param pool the worker pool
+ * @return the number of threads besides the caller's
+ */
+size_t worker_pool_size(const worker_pool_t *pool);
+
+/**
+ * Runs a task for every index from 0 to count - 1, and returns once all of
+ * them are done. Not reentrant: a task must not run another task on the
+ * same pool.
+ *
+ * @param pool the worker pool
+ * @param count the number of indices
+ * @param task the function to run for each index
+ * @param aux an auxiliary value passed to each call of task
+ */
+void worker_pool_run(worker_pool_t *pool, size_t count, worker_task_t task,
+                     void *aux);
+
+/**
+ * Stops a pool's threads and releases the memory allocated for it.
+ *
+ * @param pool the worker pool to free
+ */
+void worker_pool_free(worker_pool_t *pool);
+
+#endif // #ifndef __WORKER_POOL_H__
@@ -1,9 +1,9 @@
 #include "arrow.h"
 #include "asset.h"
 #include "collision.h"
+#include "contact_cache.h"
 #include "crate.h"
-#include "forces.h"
-#include "list.h"
+#include "emitter.h"
 #include <SDL2/SDL.h>
 #include <assert.h>
 #include <math.h>
@@ -13,39 +13,13 @@ const color_t ARROW_COLOR = {0.78, 0.773, 0.341};
 const size_t ARROW_CAPACITY = 8;
 const double DAMAGE_SCALE = 0.03;
 const double MAX_DAMAGE = 50;
+const double CRATER_RADIUS_PER_MASS = 8.0;
 
-const size_t ARROW_VERTEX_NUMBER = 5;
-const char *ARROW_INFO = "arrow";
-const char *BURST_PARTICLE_INFO = "particle";
 
 const size_t CRATE_HEAL = 30;
 const size_t SHOOTER_HP = 100;
 
-const double PARTICLE_LIFETIME = 0.8;
-const double PARTICLE_SIZE = 3.0; // for arrow trail
-const double PARTICLE_SPEED = 20.0;
-const color_t TRAIL_COLOR = {255, 100, 100};
-
-const size_t BURST_PARTICLE_PTS = 10; // for impact effect
-const double BURST_PARTICLE_RADIUS = 5;
-const double BURST_PARTICLE_MASS = 0.5;
-const color_t BURST_COLOR = {0.47, 0.17, 0.137};
-const double BURST_SPEED = 100;
-const double EPSILON =
-    1.0; // finite difference dx value for finding normal vector
-
-enum { MAX_PARTICLES = 300 };
-
-/**
- * array containing particles to be rendered
- * across different frames
- */
-particle_t particles[MAX_PARTICLES];
-
-/**
- * The length of the particle_t array, particles.
- */
-size_t particle_count = 0;
+enum { ARROW_VERTEX_NUMBER = 5 };
 
 const struct {
   double ARROW_MASS;
@@ -60,138 +34,147 @@ const struct {
 };
 
 typedef struct {
+  body_t *arrow;
   body_t *shooter;
+  level_t *level;
+  arrow_variant_t variant;
+  emitter_t trail;
 } arrow_aux_t;
 
-void arrow_clear_particles() { particle_count = 0; }
-
-size_t arrow_get_particle_count() { return particle_count; }
+/**
+ * Arrows that are currently in a level, along with who shot them.
+ * Lets the broad phase's pair callback tell arrows apart from other bodies.
+ * The records are stored inline and the array is kept between arrows, so
+ * shooting does not allocate once it has grown to fit a volley.
+ */
+static struct {
+  arrow_aux_t *records;
+  size_t count;
+  size_t capacity;
+} LIVE_ARROWS = {NULL, 0, 0};
 
-body_t *make_particle(vector_t centroid) {
-  double d_theta = M_PI / BURST_PARTICLE_PTS;
-  double theta = 0;
-  list_t *vertices = list_init(BURST_PARTICLE_PTS, free);
-  for (size_t i = 0; i < BURST_PARTICLE_PTS; i++) {
-    vector_t *point = malloc(sizeof(vector_t));
-    *point = (vector_t){centroid.x + BURST_PARTICLE_RADIUS * cos(theta),
-                        centroid.y + BURST_PARTICLE_RADIUS * sin(theta)};
-    list_add(vertices, point);
-    theta += d_theta;
+/**
+ * @param body body to look up
+ *
+ * @return the live arrow record for body, or NULL if body is not an arrow.
+ *   Only valid until the next arrow is spawned or forgotten.
+ */
+static arrow_aux_t *find_live_arrow(body_t *body) {
+  for (size_t i = 0; i < LIVE_ARROWS.count; i++) {
+    if (LIVE_ARROWS.records[i].arrow == body) {
+      return &LIVE_ARROWS.records[i];
+    }
   }
-  body_t *particle =
-      body_init_with_info(vertices, BURST_PARTICLE_MASS, BURST_COLOR,
-                          (void *)BURST_PARTICLE_INFO, NULL);
-  return particle;
+  return NULL;
 }
 
-void arrow_spawn_impact_burst(level_t *level, vector_t pos, size_t n) {
-  double y1 = level_ground_height(level, pos.x - EPSILON);
-  double y2 = level_ground_height(level, pos.x + EPSILON);
-  vector_t normal = {-(y2 - y1), 2 * EPSILON};
-  normal = vec_multiply(1.0 / vec_get_length(normal), normal);
-  for (size_t i = 0; i < n && particle_count < MAX_PARTICLES; i++) {
-    double theta = rand_double(-M_PI / 2, M_PI / 2);
-    vector_t dir = {normal.x * cos(theta) - normal.y * sin(theta),
-                    normal.x * sin(theta) + normal.y * cos(theta)};
-    vector_t vel = vec_multiply(rand_double(0.2, 1) * BURST_SPEED, dir);
-    body_t *particle = make_particle(pos);
-    body_set_velocity(particle, vel);
-    scene_add_body(level->scene, particle);
-  }
+void make_arrow_shape(vector_t verts[ARROW_VERTEX_NUMBER], vector_t pos,
+                      double shaft_len, double shaft_w, double tip_len) {
+  double hw = shaft_w * 0.5;
+  verts[0] = (vector_t){pos.x - shaft_len, pos.y - hw};
+  verts[1] = (vector_t){pos.x, pos.y - hw};
+  verts[2] = (vector_t){pos.x + tip_len, pos.y};
+  verts[3] = (vector_t){pos.x, pos.y + hw};
+  verts[4] = (vector_t){pos.x - shaft_len, pos.y + hw};
 }
 
-void arrow_add_particle_trail(body_t *arrow, arrow_variant_t variant) {
-  if (particle_count >= MAX_PARTICLES)
-    return;
+/**
+ * The outlines shared by every arrow of each variant, built on first use and
+ * kept for the life of the program, along with where each outline's centroid
+ * sits relative to the point it is built around.
+ */
+static shape_t *ARROW_SHAPES[ARROW_NVARIANTS] = {NULL};
+static vector_t ARROW_CENTROIDS[ARROW_NVARIANTS];
 
-  vector_t arrow_pos = body_get_centroid(arrow);
-  vector_t arrow_vel = body_get_velocity(arrow);
+/**
+ * @param variant the arrow variant
+ *
+ * @return the outline shared by every arrow of the variant
+ */
+static shape_t *arrow_shape(arrow_variant_t variant) {
+  if (!ARROW_SHAPES[variant]) {
+    vector_t vertices[ARROW_VERTEX_NUMBER];
+    make_arrow_shape(vertices, VEC_ZERO, ARROW_SPECS[variant].SHAFT_LEN,
+                     ARROW_SPECS[variant].SHAFT_W,
+                     ARROW_SPECS[variant].TIP_LEN);
+    ARROW_SHAPES[variant] =
+        shape_init(vertices, ARROW_VERTEX_NUMBER, &ARROW_CENTROIDS[variant]);
+  }
+  return ARROW_SHAPES[variant];
+}
 
-  vector_t dir = vec_multiply(-1 / vec_get_length(arrow_vel), arrow_vel);
+void arrow_clear_particles(level_t *level) {
+  particle_pool_clear(level->particles);
+}
 
-  vector_t offset = vec_multiply(ARROW_SPECS[variant].SHAFT_LEN, dir);
-  vector_t pos = vec_add(arrow_pos, offset);
+size_t arrow_get_particle_count(level_t *level) {
+  return level->particles->count;
+}
 
-  vector_t random_vel = {.x = rand_double(-PARTICLE_SPEED, PARTICLE_SPEED),
-                         .y = rand_double(-PARTICLE_SPEED, PARTICLE_SPEED)};
-  particles[particle_count] = (particle_t){
-      .position = pos,
-      .velocity = vec_add(vec_multiply(0.3, arrow_vel), random_vel),
-      .lifetime = PARTICLE_LIFETIME,
-      .max_lifetime = PARTICLE_LIFETIME,
-      .size = PARTICLE_SIZE,
-      .color = TRAIL_COLOR};
-  particle_count++;
+void arrow_spawn_impact_burst(level_t *level, vector_t pos) {
+  emitter_burst(level->particles, EFFECT_DUST, pos,
+                level_ground_normal(level, pos.x));
 }
 
-void arrow_update_particles(level_t *level, double dt,
-                            arrow_variant_t variant) {
-  scene_t *scene = level->scene;
-  size_t num_bodies = scene_bodies(scene);
-  for (size_t i = 0; i < num_bodies; i++) {
-    body_t *b = scene_get_body(scene, i);
-    if (strcmp(body_get_info(b), ARROW_INFO) == 0) {
-      arrow_add_particle_trail(b, variant);
-    }
+/**
+ * Runs the trail emitter of a live arrow, from the tail of the arrow.
+ */
+static void update_trail(arrow_aux_t *record, double dt) {
+  body_t *arrow = record->arrow;
+  vector_t arrow_vel = body_get_velocity(arrow);
+  double speed = vec_get_length(arrow_vel);
+  if (speed == 0) {
+    return;
   }
-  for (size_t i = 0; i < particle_count;) {
-    particles[i].lifetime -= dt;
-    particles[i].position =
-        vec_add(particles[i].position, vec_multiply(dt, particles[i].velocity));
+  vector_t back = vec_multiply(-1 / speed, arrow_vel);
+  vector_t offset = vec_multiply(ARROW_SPECS[record->variant].SHAFT_LEN, back);
+  vector_t pos = vec_add(body_get_centroid(arrow), offset);
+  emitter_update(&record->trail, record->level->particles, dt, pos, arrow_vel,
+                 back);
+}
 
-    if (particles[i].lifetime <= 0) {
-      particles[i] = particles[particle_count - 1];
-      particle_count--;
-    } else {
-      i++;
+void arrow_update_particles(level_t *level, double dt) {
+  for (size_t i = 0; i < LIVE_ARROWS.count; i++) {
+    arrow_aux_t *record = &LIVE_ARROWS.records[i];
+    if (record->level == level && !body_is_removed(record->arrow)) {
+      update_trail(record, dt);
     }
   }
+  // particles only feel the field's uniform part; drag and zones vary per
+  // particle and are not worth the cost for effects
+  const force_field_t *field = level->field;
+  particle_pool_update(level->particles, dt,
+                       vec_add(field->gravity, field->wind), level->ground);
 }
 
-void arrow_render_particles() {
-  SDL_Renderer *ren = sdl_get_renderer();
-  SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
-  for (size_t i = 0; i < particle_count; i++) {
-    particle_t p = particles[i];
-
-    size_t alpha = (size_t)(255 * (p.lifetime / p.max_lifetime));
-    SDL_SetRenderDrawColor(ren, p.color.red, p.color.green, p.color.blue,
-                           alpha);
-
-    vector_t screen_pos = get_window_position(p.position, get_window_center());
-    SDL_Rect rect = {.x = screen_pos.x - p.size / 2,
-                     .y = screen_pos.y - p.size / 2,
-                     .w = p.size,
-                     .h = p.size};
-    SDL_RenderFillRect(ren, &rect);
+void arrow_render_particles(level_t *level) {
+  const particle_pool_t *pool = level->particles;
+  vector_t window_center = get_window_center();
+  for (size_t k = 0; k < pool->count; k++) {
+    size_t i = particle_pool_slot(pool, k);
+    if (pool->lifetime[i] <= 0) {
+      continue;
+    }
+    uint32_t rgba = pool->rgba[i];
+    float fade = pool->lifetime[i] / pool->max_lifetime[i];
+    SDL_Color color = {rgba >> 24, rgba >> 16 & 0xff, rgba >> 8 & 0xff,
+                       (rgba & 0xff) * fade};
+
+    vector_t pos = {pool->x[i], pool->y[i]};
+    vector_t screen_pos = get_window_position(pos, window_center);
+    float size = pool->size[i];
+    sdl_batch_rect(screen_pos.x - size / 2, screen_pos.y - size / 2, size,
+                   size, color);
   }
 }
 
-list_t *make_arrow_shape(vector_t pos, double shaft_len, double shaft_w,
-                         double tip_len) {
-  double hw = shaft_w * 0.5;
-  list_t *v = list_init(ARROW_VERTEX_NUMBER, free);
-  const vector_t verts[] = {{pos.x - shaft_len, pos.y - hw},
-                            {pos.x, pos.y - hw},
-                            {pos.x + tip_len, pos.y},
-                            {pos.x, pos.y + hw},
-                            {pos.x - shaft_len, pos.y + hw}};
-
-  for (size_t i = 0; i < ARROW_VERTEX_NUMBER; ++i) {
-    vector_t *p = malloc(sizeof *p);
-    *p = verts[i];
-    list_add(v, p);
-  }
-  return v;
-};
-
 void arrow_collision_handler(body_t *arrow, body_t *target, vector_t axis,
                              void *aux, double unused) {
   arrow_aux_t *arrow_details = aux;
   if (target == arrow_details->shooter) {
     return;
   }
-  if (strcmp(body_get_info(target), get_ground_info()) == 0) {
+  if (body_get_kind(target) == BODY_GROUND) {
     return;
   }
 
@@ -201,10 +184,12 @@ void arrow_collision_handler(body_t *arrow, body_t *target, vector_t axis,
       fmin(MAX_DAMAGE, DAMAGE_SCALE * mass_factor *
                            vec_get_length(body_get_velocity(arrow)));
 
-  if (crate_is(target)) {
+  if (body_get_kind(target) == BODY_CRATE) {
     crate_info_t *info = body_get_info(target);
     info->hp -= damage;
     if (info->hp <= 0) {
+      emitter_burst(arrow_details->level->particles, EFFECT_SPLINTERS,
+                    body_get_centroid(target), (vector_t){0, 1});
       asset_remove_body(target);
       body_remove(target);
       int32_t *shooter_hp = body_get_info(arrow_details->shooter);
@@ -213,53 +198,105 @@ void arrow_collision_handler(body_t *arrow, body_t *target, vector_t axis,
                         : *shooter_hp + CRATE_HEAL;
     }
   }
-  int32_t *hp = body_get_info(target);
-  if (hp) {
+  if (body_get_kind(target) == BODY_PLAYER) {
+    int32_t *hp = body_get_info(target);
     *hp -= (int32_t)damage;
   }
   body_remove(arrow);
 }
 
-body_t *arrow_spawn(scene_t *scene, body_t *shooter, vector_t start_vel,
+body_t *arrow_spawn(level_t *level, body_t *shooter, vector_t start_vel,
                     arrow_variant_t variant) {
   start_vel = vec_multiply(ARROW_SPECS[variant].VEL_MUL, start_vel);
   vector_t dir = vec_multiply(1.0 / vec_get_length(start_vel), start_vel);
   vector_t offset = vec_multiply(
       ARROW_SPECS[variant].SHAFT_LEN + ARROW_SPECS[variant].TIP_LEN * 0.5, dir);
-  list_t *shape = make_arrow_shape(vec_add(body_get_centroid(shooter), offset),
-                                   ARROW_SPECS[variant].SHAFT_LEN,
-                                   ARROW_SPECS[variant].SHAFT_W,
-                                   ARROW_SPECS[variant].TIP_LEN);
-  body_t *arrow = body_init_with_info(shape, ARROW_SPECS[variant].ARROW_MASS,
-                                      ARROW_COLOR, (void *)ARROW_INFO, NULL);
+  shape_t *shape = arrow_shape(variant);
+  vector_t pos = vec_add(body_get_centroid(shooter), offset);
+  body_t *arrow =
+      level_make_body(level, BODY_ARROW, shape,
+                      vec_add(pos, ARROW_CENTROIDS[variant]),
+                      ARROW_SPECS[variant].ARROW_MASS, ARROW_COLOR);
+  body_set_collision_filter(arrow, LAYER_PROJECTILE, LAYER_TARGET);
   body_set_velocity(arrow, start_vel);
-  scene_add_body(scene, arrow);
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *other = scene_get_body(scene, i);
-    if (other == arrow || other == shooter ||
-        strcmp(body_get_info(other), get_ground_info()) == 0 ||
-        strcmp(body_get_info(other), ARROW_INFO) == 0) {
-      continue;
-    }
-    arrow_aux_t *aux = malloc(sizeof(arrow_aux_t));
-    assert(aux);
-    aux->shooter = shooter;
-    create_collision(scene, arrow, other, arrow_collision_handler, aux, 0.0,
-                     free);
+  body_set_integrator(arrow, level->integrator, level->max_step_travel);
+  body_set_accel_field(arrow, force_field_accel, level->field);
+  level_add_body(level, arrow);
+
+  if (LIVE_ARROWS.count == LIVE_ARROWS.capacity) {
+    LIVE_ARROWS.capacity =
+        LIVE_ARROWS.capacity ? LIVE_ARROWS.capacity * 2 : ARROW_CAPACITY;
+    LIVE_ARROWS.records = realloc(
+        LIVE_ARROWS.records, sizeof(arrow_aux_t) * LIVE_ARROWS.capacity);
+    assert(LIVE_ARROWS.records);
   }
+  arrow_aux_t *record = &LIVE_ARROWS.records[LIVE_ARROWS.count];
+  *record = (arrow_aux_t){.arrow = arrow,
+                          .shooter = shooter,
+                          .level = level,
+                          .variant = variant};
+  emitter_init(&record->trail, EFFECT_TRAIL);
+  LIVE_ARROWS.count++;
   return arrow;
 }
 
-double arrow_front_offset(arrow_variant_t variant) {
-  return ARROW_SPECS[variant].SHAFT_LEN + ARROW_SPECS[variant].TIP_LEN * 0.5;
+void arrow_handle_pair(body_t *body1, body_t *body2, void *aux) {
+  body_t *arrow = body1;
+  body_t *target = body2;
+  if (body_get_kind(arrow) != BODY_ARROW) {
+    arrow = body2;
+    target = body1;
+  }
+  // the broad phase's collision filters only pair arrows with targets
+  if (body_get_kind(arrow) != BODY_ARROW || body_is_removed(arrow) ||
+      body_is_removed(target)) {
+    return;
+  }
+  arrow_aux_t *arrow_details = find_live_arrow(arrow);
+  if (!arrow_details) {
+    return;
+  }
+
+  arrow_tick_t *tick = aux;
+  vector_t displacement = body_get_predicted_displacement(arrow);
+  swept_collision_info_t hit;
+  contact_state_t state =
+      contact_cache_sweep(tick->contacts, arrow, displacement, target, &hit);
+  if (state == CONTACT_ENTER) {
+    // move the arrow to where it struck so the hit is seen at the target
+    body_set_centroid(arrow, vec_add(body_get_centroid(arrow),
+                                     vec_multiply(hit.time, displacement)));
+    arrow_collision_handler(arrow, target, hit.axis, arrow_details, 0.0);
+  }
 }
 
-bool particle_check_ground_collision(level_t *level, body_t *body) {
-  return alt_check_collision_certain_body(level, body, BURST_PARTICLE_INFO);
+void arrow_forget_removed() {
+  size_t kept = 0;
+  for (size_t i = 0; i < LIVE_ARROWS.count; i++) {
+    if (!body_is_removed(LIVE_ARROWS.records[i].arrow)) {
+      LIVE_ARROWS.records[kept++] = LIVE_ARROWS.records[i];
+    }
+  }
+  LIVE_ARROWS.count = kept;
+}
+
+void arrow_forget_all() {
+  free(LIVE_ARROWS.records);
+  LIVE_ARROWS.records = NULL;
+  LIVE_ARROWS.count = 0;
+  LIVE_ARROWS.capacity = 0;
+}
+
+double arrow_crater_radius(body_t *arrow) {
+  return CRATER_RADIUS_PER_MASS * body_get_mass(arrow);
+}
+
+double arrow_front_offset(arrow_variant_t variant) {
+  return ARROW_SPECS[variant].SHAFT_LEN + ARROW_SPECS[variant].TIP_LEN * 0.5;
 }
 
 bool arrow_check_ground_collision(level_t *level, body_t *body) {
-  return alt_check_collision_certain_body(level, body, ARROW_INFO);
+  return alt_check_collision_certain_body(level, body, BODY_ARROW);
 }
 
 double arrow_vel_scale(arrow_variant_t variant) {
@@ -102,6 +102,9 @@ void asset_reset_asset_list() {
 list_t *asset_get_asset_list() { return ASSET_LIST; }
 
 void asset_remove_body(body_t *body) {
+  if (!ASSET_LIST) {
+    return;
+  }
   size_t i = list_size(ASSET_LIST);
   while (i > 0) {
     i--;
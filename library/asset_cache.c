@@ -1,6 +1,7 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include <assert.h>
+#include <string.h>
 
 #include "asset_cache.h"
 #include "list.h"
@@ -13,7 +14,8 @@ const size_t INITIAL_CAPACITY = 5;
 
 typedef struct {
   asset_type_t type;
-  const char *filepath;
+  // copied, since callers may pass paths that do not outlive the cache
+  char *filepath;
   void *obj;
 } entry_t;
 
@@ -23,6 +25,7 @@ static void asset_cache_free_entry(entry_t *entry) {
   } else if (entry->type == ASSET_TEXT) {
     TTF_CloseFont(entry->obj);
   }
+  free(entry->filepath);
   free(entry);
 }
 
@@ -58,12 +61,12 @@ void *asset_cache_obj_get_or_create(asset_type_t ty, const char *filepath) {
   if (ty == ASSET_IMAGE) {
     SDL_Texture *texture = sdl_get_image_texture(filepath);
     new->type = ty;
-    new->filepath = filepath;
+    new->filepath = strdup(filepath);
     new->obj = texture;
   } else if (ty == ASSET_TEXT) {
     TTF_Font *font = TTF_OpenFont(filepath, FONT_SIZE);
     new->type = ty;
-    new->filepath = filepath;
+    new->filepath = strdup(filepath);
     new->obj = font;
   }
   list_add(ASSET_CACHE, new);
@@ -0,0 +1,91 @@
+#include "ballistic.h"
+
+#include <math.h>
+
+enum {
+  // arcs are checked against the terrain at this many points
+  CLEARANCE_SAMPLES = 32
+};
+
+size_t ballistic_solve(vector_t offset, double speed, vector_t accel,
+                       ballistic_arc_t arcs[2]) {
+  double g = vec_get_length(accel);
+  double distance = vec_get_length(offset);
+  if (g == 0) {
+    arcs[0] = (ballistic_arc_t){.angle = atan2(offset.y, offset.x),
+                                .time = distance / speed};
+    return 1;
+  }
+
+  // work in a frame where the acceleration points straight down: `up` is
+  // against it and `across` is a quarter turn clockwise from `up`
+  vector_t up = vec_multiply(-1 / g, accel);
+  vector_t across = {up.y, -up.x};
+  double x = vec_dot(offset, across);
+  double y = vec_dot(offset, up);
+  double side = x < 0 ? -1 : 1;
+  x = fabs(x);
+
+  double v2 = speed * speed;
+  double discriminant = v2 * v2 - g * (g * x * x + 2 * y * v2);
+  if (discriminant < 0) {
+    return 0;
+  }
+  if (x == 0) {
+    // straight along `up`: a point above is reached on the way up, and a
+    // point below either by firing down or on the way back down
+    double angle_up = atan2(up.y, up.x);
+    double reach = sqrt(v2 - 2 * g * y);
+    if (y > 0) {
+      arcs[0] = (ballistic_arc_t){.angle = angle_up,
+                                  .time = (speed - reach) / g};
+      return 1;
+    }
+    arcs[0] = (ballistic_arc_t){.angle = atan2(-up.y, -up.x),
+                                .time = (reach - speed) / g};
+    arcs[1] = (ballistic_arc_t){.angle = angle_up,
+                                .time = (speed + reach) / g};
+    return 2;
+  }
+
+  double root = sqrt(discriminant);
+  // elevations above `across`, the lower one first
+  double elevations[2] = {atan((v2 - root) / (g * x)),
+                          atan((v2 + root) / (g * x))};
+  size_t count = root == 0 ? 1 : 2;
+  for (size_t i = 0; i < count; i++) {
+    double c = cos(elevations[i]);
+    double s = sin(elevations[i]);
+    vector_t dir = vec_add(vec_multiply(side * c, across),
+                           vec_multiply(s, up));
+    arcs[i] = (ballistic_arc_t){.angle = atan2(dir.y, dir.x),
+                                .time = x / (speed * c)};
+  }
+  return count;
+}
+
+vector_t ballistic_position(vector_t start, vector_t vel, vector_t accel,
+                            double t) {
+  return (vector_t){start.x + vel.x * t + 0.5 * accel.x * t * t,
+                    start.y + vel.y * t + 0.5 * accel.y * t * t};
+}
+
+bool ballistic_clears_terrain(const heightfield_t *ground, vector_t start,
+                              vector_t vel, vector_t accel, double time) {
+  double xs[CLEARANCE_SAMPLES - 1];
+  double ys[CLEARANCE_SAMPLES - 1];
+  for (size_t k = 1; k < CLEARANCE_SAMPLES; k++) {
+    vector_t p =
+        ballistic_position(start, vel, accel, time * k / CLEARANCE_SAMPLES);
+    xs[k - 1] = p.x;
+    ys[k - 1] = p.y;
+  }
+  double heights[CLEARANCE_SAMPLES - 1];
+  heightfield_heights(ground, xs, heights, CLEARANCE_SAMPLES - 1);
+  for (size_t k = 0; k < CLEARANCE_SAMPLES - 1; k++) {
+    if (ys[k] <= heights[k]) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,355 @@
+#include "body.h"
+#include "color.h"
+#include "integrator.h"
+#include "list.h"
+#include "polygon.h"
+#include "shape.h"
+#include "vector.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+  // body_get_aabb() rotates a shape's vertices this many at a time
+  AABB_BLOCK = 16
+};
+
+typedef struct body {
+  shape_t *shape;
+  // the shape placed at the body's pose, only rebuilt by body_get_polygon()
+  // after the pose has changed
+  polygon_t world;
+  bool world_dirty;
+  double mass;
+  color_t color;
+  vector_t centroid;
+  // the centroid before the last body_tick(), for render interpolation
+  vector_t prev_centroid;
+  vector_t velocity;
+  double rotation;
+  double cos_rotation;
+  double sin_rotation;
+  vector_t force;
+  vector_t impulse;
+  // the motion body_predict() worked out for the coming tick, which
+  // body_tick() reuses while `predicted` is set and dt matches
+  vector_t next_centroid;
+  vector_t next_velocity;
+  vector_t displacement;
+  double predicted_dt;
+  bool predicted;
+  integrator_t integrator;
+  double max_step_travel;
+  accel_func_t field;
+  void *field_aux;
+  // the bounding box of the rotated shape, relative to the centroid
+  aabb_t local_aabb;
+  bool aabb_dirty;
+  bool removed;
+  body_kind_t kind;
+  uint32_t collision_layers;
+  uint32_t collision_mask;
+  uint32_t render_layers;
+  void *info;
+  free_func_t info_freer;
+} body_t;
+
+/**
+ * Sets up a body as if it had just been created.
+ * The body's world polygon must already be initialized.
+ *
+ * @param body the body to set up
+ * @param shape the body's shape; the body takes over the caller's reference
+ * @param centroid where to put the shape's centroid
+ * @param mass the body's mass
+ * @param color the body's color
+ * @param info the body's info, or NULL
+ * @param info_freer frees the info, or NULL
+ */
+static void reset_body(body_t *body, shape_t *shape, vector_t centroid,
+                       double mass, color_t color, void *info,
+                       free_func_t info_freer) {
+  body->shape = shape;
+  body->world_dirty = true;
+  body->mass = mass;
+  body->color = color;
+  body->centroid = centroid;
+  body->prev_centroid = centroid;
+  body->velocity = VEC_ZERO;
+  body->rotation = 0;
+  body->cos_rotation = 1;
+  body->sin_rotation = 0;
+  body->force = VEC_ZERO;
+  body->impulse = VEC_ZERO;
+  body->displacement = VEC_ZERO;
+  body->predicted = false;
+  body->integrator = INTEGRATOR_VELOCITY_VERLET;
+  body->max_step_travel = INFINITY;
+  body->field = NULL;
+  body->field_aux = NULL;
+  body->aabb_dirty = true;
+  body->removed = false;
+  body->kind = BODY_UNKNOWN;
+  body->collision_layers = 0;
+  body->collision_mask = 0;
+  body->render_layers = RENDER_SHAPE;
+  body->info = info;
+  body->info_freer = info_freer;
+}
+
+/**
+ * Allocates a body whose world vertices have not been materialized yet,
+ * and sets it up.
+ */
+static body_t *alloc_body(shape_t *shape, vector_t centroid, double mass,
+                          color_t color, void *info, free_func_t info_freer) {
+  body_t *body = malloc(sizeof(body_t));
+  assert(body);
+  polygon_init(&body->world);
+  reset_body(body, shape, centroid, mass, color, info, info_freer);
+  return body;
+}
+
+body_t *body_init(list_t *shape, double mass, color_t color) {
+  return body_init_with_info(shape, mass, color, NULL, NULL);
+}
+
+body_t *body_init_with_info(list_t *shape, double mass, color_t color,
+                            void *info, free_func_t info_freer) {
+  size_t n = list_size(shape);
+  vector_t *vertices = malloc(sizeof(vector_t) * n);
+  assert(vertices);
+  for (size_t i = 0; i < n; i++) {
+    vertices[i] = *(vector_t *)list_get(shape, i);
+  }
+  list_free(shape);
+  vector_t centroid;
+  shape_t *local = shape_init(vertices, n, &centroid);
+  free(vertices);
+  return alloc_body(local, centroid, mass, color, info, info_freer);
+}
+
+body_t *body_init_with_shape(shape_t *shape, vector_t centroid, double mass,
+                             color_t color, void *info,
+                             free_func_t info_freer) {
+  return alloc_body(shape_retain(shape), centroid, mass, color, info,
+                    info_freer);
+}
+
+void body_recycle(body_t *body, shape_t *shape, vector_t centroid,
+                  double mass, color_t color) {
+  if (body->info_freer && body->info) {
+    body->info_freer(body->info);
+  }
+  // retain first, in case the body already has this shape
+  shape_retain(shape);
+  shape_release(body->shape);
+  reset_body(body, shape, centroid, mass, color, NULL, NULL);
+}
+
+const polygon_t *body_get_polygon(body_t *body) {
+  if (body->world_dirty) {
+    polygon_transform(&body->world, shape_get_polygon(body->shape),
+                      body->centroid, body->cos_rotation, body->sin_rotation);
+    body->world_dirty = false;
+  }
+  return &body->world;
+}
+
+aabb_t body_get_aabb(body_t *body) {
+  if (body->aabb_dirty) {
+    // rotate the shape about the origin, so the box is independent of
+    // where the body is and only needs rebuilding when it turns
+    const polygon_t *polygon = shape_get_polygon(body->shape);
+    size_t n = polygon->num_vertices;
+    aabb_t box = {.min = {INFINITY, INFINITY}, .max = {-INFINITY, -INFINITY}};
+    double xs[AABB_BLOCK];
+    double ys[AABB_BLOCK];
+    for (size_t first = 0; first < n; first += AABB_BLOCK) {
+      size_t count = fmin(n - first, AABB_BLOCK);
+      memcpy(xs, polygon_xs(polygon) + first, sizeof(double) * count);
+      memcpy(ys, polygon_ys(polygon) + first, sizeof(double) * count);
+      vec_batch_rotate(xs, ys, count, body->cos_rotation, body->sin_rotation);
+      for (size_t i = 0; i < count; i++) {
+        box.min.x = fmin(box.min.x, xs[i]);
+        box.min.y = fmin(box.min.y, ys[i]);
+        box.max.x = fmax(box.max.x, xs[i]);
+        box.max.y = fmax(box.max.y, ys[i]);
+      }
+    }
+    body->local_aabb = box;
+    body->aabb_dirty = false;
+  }
+  return (aabb_t){.min = vec_add(body->centroid, body->local_aabb.min),
+                  .max = vec_add(body->centroid, body->local_aabb.max)};
+}
+
+void *body_get_info(body_t *body) { return body->info; }
+
+body_kind_t body_get_kind(body_t *body) { return body->kind; }
+
+void body_set_kind(body_t *body, body_kind_t kind) { body->kind = kind; }
+
+void body_set_collision_filter(body_t *body, uint32_t layers, uint32_t mask) {
+  body->collision_layers = layers;
+  body->collision_mask = mask;
+}
+
+bool body_can_collide(body_t *body1, body_t *body2) {
+  return (body1->collision_layers & body2->collision_mask) &&
+         (body2->collision_layers & body1->collision_mask);
+}
+
+bool body_is_collidable(body_t *body) {
+  return body->collision_layers && body->collision_mask;
+}
+
+uint32_t body_get_render_layers(body_t *body) { return body->render_layers; }
+
+void body_set_render_layers(body_t *body, uint32_t layers) {
+  body->render_layers = layers;
+}
+
+vector_t body_get_centroid(body_t *body) { return body->centroid; }
+
+void body_set_centroid(body_t *body, vector_t x) {
+  body->centroid = x;
+  body->prev_centroid = x;
+  body->world_dirty = true;
+  body->predicted = false;
+}
+
+vector_t body_get_interpolated_centroid(body_t *body, double alpha) {
+  vector_t delta = vec_subtract(body->centroid, body->prev_centroid);
+  return vec_add(body->prev_centroid, vec_multiply(alpha, delta));
+}
+
+vector_t body_get_velocity(body_t *body) { return body->velocity; }
+
+void body_set_velocity(body_t *body, vector_t v) {
+  body->velocity = v;
+  body->predicted = false;
+}
+
+double body_area(body_t *body) { return shape_area(body->shape); }
+
+color_t body_get_color(body_t *body) { return body->color; }
+
+void body_set_color(body_t *body, color_t color) { body->color = color; }
+
+double body_get_rotation(body_t *body) { return body->rotation; }
+
+void body_set_rotation(body_t *body, double angle) {
+  if (angle == body->rotation) {
+    return;
+  }
+  body->rotation = angle;
+  body->cos_rotation = cos(angle);
+  body->sin_rotation = sin(angle);
+  body->aabb_dirty = true;
+  body->world_dirty = true;
+}
+
+void body_set_integrator(body_t *body, integrator_t integrator,
+                         double max_step_travel) {
+  body->integrator = integrator;
+  body->max_step_travel = max_step_travel;
+  body->predicted = false;
+}
+
+void body_set_accel_field(body_t *body, accel_func_t field, void *aux) {
+  body->field = field;
+  body->field_aux = aux;
+  body->predicted = false;
+}
+
+/**
+ * accel_func_t for a body: the acceleration from the forces applied this
+ * tick plus that of the body's field, if any.
+ *
+ * @param aux the body
+ */
+static vector_t body_accel(vector_t pos, vector_t vel, void *aux) {
+  body_t *body = aux;
+  vector_t accel = vec_multiply(1 / body->mass, body->force);
+  if (body->field) {
+    accel = vec_add(accel, body->field(pos, vel, body->field_aux));
+  }
+  return accel;
+}
+
+/**
+ * Computes where a body will be and how fast it will be moving after a tick
+ * of length dt. The impulses take effect at the start of the tick and the
+ * forces are held constant through it.
+ *
+ * @param body the body to integrate
+ * @param dt the length of the tick
+ * @param pos set to the body's next centroid
+ * @param vel set to the body's next velocity
+ */
+static void integrate(body_t *body, double dt, vector_t *pos, vector_t *vel) {
+  *pos = body->centroid;
+  *vel = vec_add(body->velocity, vec_multiply(1 / body->mass, body->impulse));
+  integrator_advance(body->integrator, pos, vel, dt, body->max_step_travel,
+                     body_accel, body);
+}
+
+void body_predict(body_t *body, double dt) {
+  integrate(body, dt, &body->next_centroid, &body->next_velocity);
+  body->displacement = vec_subtract(body->next_centroid, body->centroid);
+  body->predicted_dt = dt;
+  body->predicted = true;
+}
+
+vector_t body_get_predicted_displacement(body_t *body) {
+  return body->displacement;
+}
+
+void body_tick(body_t *body, double dt) {
+  vector_t prev = body->centroid;
+  vector_t pos, vel;
+  if (body->predicted && body->predicted_dt == dt) {
+    pos = body->next_centroid;
+    vel = body->next_velocity;
+  } else {
+    integrate(body, dt, &pos, &vel);
+  }
+  body->velocity = vel;
+  body_set_centroid(body, pos);
+  body->prev_centroid = prev;
+  body_reset(body);
+}
+
+double body_get_mass(body_t *body) { return body->mass; }
+
+void body_add_force(body_t *body, vector_t force) {
+  body->force = vec_add(body->force, force);
+  body->predicted = false;
+}
+
+void body_add_impulse(body_t *body, vector_t impulse) {
+  body->impulse = vec_add(body->impulse, impulse);
+  body->predicted = false;
+}
+
+void body_reset(body_t *body) {
+  body->force = VEC_ZERO;
+  body->impulse = VEC_ZERO;
+  body->predicted = false;
+}
+
+void body_remove(body_t *body) { body->removed = true; }
+
+bool body_is_removed(body_t *body) { return body->removed; }
+
+void body_free(body_t *body) {
+  if (body->info_freer && body->info) {
+    body->info_freer(body->info);
+  }
+  shape_release(body->shape);
+  polygon_free(&body->world);
+  free(body);
+}
@@ -0,0 +1,51 @@
+#include "body_set.h"
+#include "body.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t BODY_SET_INIT_CAPACITY = 8;
+
+body_set_t *body_set_init(void) {
+  body_set_t *set = malloc(sizeof(body_set_t));
+  assert(set);
+  set->bodies = malloc(sizeof(body_t *) * BODY_SET_INIT_CAPACITY);
+  assert(set->bodies);
+  set->count = 0;
+  set->capacity = BODY_SET_INIT_CAPACITY;
+  return set;
+}
+
+void body_set_add(body_set_t *set, body_t *body) {
+  if (set->count == set->capacity) {
+    set->capacity *= 2;
+    set->bodies = realloc(set->bodies, sizeof(body_t *) * set->capacity);
+    assert(set->bodies);
+  }
+  set->bodies[set->count] = body;
+  set->count++;
+}
+
+body_t *body_set_remove(body_set_t *set, size_t index) {
+  assert(index < set->count);
+  body_t *body = set->bodies[index];
+  set->count--;
+  memmove(set->bodies + index, set->bodies + index + 1,
+          sizeof(body_t *) * (set->count - index));
+  return body;
+}
+
+bool body_set_contains(const body_set_t *set, const body_t *body) {
+  for (size_t i = 0; i < set->count; i++) {
+    if (set->bodies[i] == body) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void body_set_free(body_set_t *set) {
+  free(set->bodies);
+  free(set);
+}
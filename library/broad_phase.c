@@ -0,0 +1,196 @@
+#include "broad_phase.h"
+#include "body.h"
+#include "body_set.h"
+#include "collision.h"
+#include "vector.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t BROAD_PHASE_INIT_CAPACITY = 16;
+
+typedef struct {
+  body_t *body;
+  aabb_t box;
+  bool immovable;
+} proxy_t;
+
+/**
+ * A growable array of proxies, kept sorted by the left edges of their boxes.
+ */
+typedef struct {
+  proxy_t *proxies;
+  size_t count;
+  size_t capacity;
+  // the widest box in the list, so a search by left edge knows how far left
+  // of a point an overlapping box can start
+  double max_width;
+} proxy_list_t;
+
+typedef struct broad_phase {
+  // rebuilt every tick
+  proxy_list_t moving;
+  // only rebuilt by broad_phase_set_static()
+  proxy_list_t fixed;
+} broad_phase_t;
+
+/**
+ * Gets the cached bounding box of a body, extended to cover the motion
+ * body_predict() found for the next dt seconds.
+ *
+ * @param body the body to bound
+ * @param dt the length of the upcoming tick
+ * @return a proxy holding the body and its bounding box
+ */
+static proxy_t make_proxy(body_t *body, double dt) {
+  bool immovable = body_get_mass(body) == INFINITY;
+  aabb_t box = body_get_aabb(body);
+  if (dt > 0) {
+    box = aabb_sweep(box, body_get_predicted_displacement(body));
+  }
+  return (proxy_t){.body = body, .box = box, .immovable = immovable};
+}
+
+/**
+ * qsort() comparator ordering proxies by the left edge of their boxes.
+ */
+static int compare_min_x(const void *a, const void *b) {
+  double x1 = ((const proxy_t *)a)->box.min.x;
+  double x2 = ((const proxy_t *)b)->box.min.x;
+  return (x1 > x2) - (x1 < x2);
+}
+
+/**
+ * Appends a proxy for each body in a set that is not marked for removal and
+ * can collide with something, growing the list if needed.
+ *
+ * @param list the list to append to
+ * @param set the bodies to add
+ * @param dt the length of the upcoming tick, or 0 for bodies that stay put
+ */
+static void add_proxies(proxy_list_t *list, const body_set_t *set, double dt) {
+  size_t needed = list->count + set->count;
+  if (needed > list->capacity) {
+    while (list->capacity < needed) {
+      list->capacity *= 2;
+    }
+    list->proxies = realloc(list->proxies, sizeof(proxy_t) * list->capacity);
+    assert(list->proxies);
+  }
+  for (size_t i = 0; i < set->count; i++) {
+    body_t *body = set->bodies[i];
+    if (body_is_removed(body) || !body_is_collidable(body)) {
+      continue;
+    }
+    proxy_t proxy = make_proxy(body, dt);
+    list->max_width = fmax(list->max_width, proxy.box.max.x - proxy.box.min.x);
+    list->proxies[list->count] = proxy;
+    list->count++;
+  }
+}
+
+/**
+ * Calls the handler for a pair of proxies if their boxes overlap vertically
+ * and their bodies may collide. The caller has already checked that the
+ * boxes overlap horizontally.
+ */
+static void test_pair(proxy_t *a, proxy_t *b, pair_handler_t handler,
+                      void *aux) {
+  if ((a->immovable && b->immovable) || !body_can_collide(a->body, b->body)) {
+    return;
+  }
+  if (a->box.max.y < b->box.min.y || b->box.max.y < a->box.min.y) {
+    return;
+  }
+  handler(a->body, b->body, aux);
+}
+
+/**
+ * Finds the first proxy in a list whose box starts at or right of an x
+ * position.
+ *
+ * @param list the list to search, sorted by the left edges of its boxes
+ * @param x the x position
+ * @return the index of the proxy, or the list's count if there is none
+ */
+static size_t first_proxy_from(const proxy_list_t *list, double x) {
+  size_t lo = 0;
+  size_t hi = list->count;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (list->proxies[mid].box.min.x < x) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/**
+ * Allocates a proxy list's array.
+ */
+static void init_list(proxy_list_t *list) {
+  list->proxies = malloc(sizeof(proxy_t) * BROAD_PHASE_INIT_CAPACITY);
+  assert(list->proxies);
+  list->count = 0;
+  list->capacity = BROAD_PHASE_INIT_CAPACITY;
+  list->max_width = 0;
+}
+
+broad_phase_t *broad_phase_init(void) {
+  broad_phase_t *bp = malloc(sizeof(broad_phase_t));
+  assert(bp);
+  init_list(&bp->moving);
+  init_list(&bp->fixed);
+  return bp;
+}
+
+void broad_phase_set_static(broad_phase_t *bp, const body_set_t *bodies) {
+  bp->fixed.count = 0;
+  bp->fixed.max_width = 0;
+  add_proxies(&bp->fixed, bodies, 0);
+  qsort(bp->fixed.proxies, bp->fixed.count, sizeof(proxy_t), compare_min_x);
+}
+
+void broad_phase_update(broad_phase_t *bp, body_set_t *const *moving,
+                        size_t num_sets, double dt) {
+  bp->moving.count = 0;
+  bp->moving.max_width = 0;
+  for (size_t s = 0; s < num_sets; s++) {
+    add_proxies(&bp->moving, moving[s], dt);
+  }
+  qsort(bp->moving.proxies, bp->moving.count, sizeof(proxy_t), compare_min_x);
+}
+
+void broad_phase_query(broad_phase_t *bp, pair_handler_t handler, void *aux) {
+  proxy_list_t *moving = &bp->moving;
+  proxy_list_t *fixed = &bp->fixed;
+  for (size_t i = 0; i < moving->count; i++) {
+    proxy_t *a = &moving->proxies[i];
+    // Proxies are sorted by min x, so once one starts past a's right edge
+    // none of the remaining ones can overlap it either.
+    for (size_t j = i + 1;
+         j < moving->count && moving->proxies[j].box.min.x <= a->box.max.x;
+         j++) {
+      test_pair(a, &moving->proxies[j], handler, aux);
+    }
+    // no static box starting further left than its widest can reach a
+    size_t first = first_proxy_from(fixed, a->box.min.x - fixed->max_width);
+    for (size_t j = first;
+         j < fixed->count && fixed->proxies[j].box.min.x <= a->box.max.x;
+         j++) {
+      proxy_t *b = &fixed->proxies[j];
+      if (b->box.max.x >= a->box.min.x) {
+        test_pair(a, b, handler, aux);
+      }
+    }
+  }
+}
+
+void broad_phase_free(broad_phase_t *bp) {
+  free(bp->moving.proxies);
+  free(bp->fixed.proxies);
+  free(bp);
+}
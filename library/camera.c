@@ -1,6 +1,7 @@
 #include "camera.h"
 #include "sdl_wrapper.h"
 #include <SDL2/SDL.h>
+#include <math.h>
 #include <stdlib.h>
 
 const double ZOOM_NORMAL = 1.0;
@@ -9,17 +10,17 @@ void clamp_center(camera_t *cam) {
   double half_w = (cam->screen_max.x - cam->screen_min.x) * 0.5 / cam->zoom;
   double half_h = (cam->screen_max.y - cam->screen_min.y) * 0.5 / cam->zoom;
 
-  if (cam->center.x < cam->screen_min.x + half_w) {
-    cam->center.x = cam->screen_min.x + half_w;
+  if (cam->center.x < cam->world_min.x + half_w) {
+    cam->center.x = cam->world_min.x + half_w;
   }
-  if (cam->center.x > cam->screen_max.x - half_w) {
-    cam->center.x = cam->screen_max.x - half_w;
+  if (cam->center.x > cam->world_max.x - half_w) {
+    cam->center.x = cam->world_max.x - half_w;
   }
-  if (cam->center.y < cam->screen_min.y + half_h) {
-    cam->center.y = cam->screen_min.y + half_h;
+  if (cam->center.y < cam->world_min.y + half_h) {
+    cam->center.y = cam->world_min.y + half_h;
   }
-  if (cam->center.y > cam->screen_max.y - half_h) {
-    cam->center.y = cam->screen_max.y - half_h;
+  if (cam->center.y > cam->world_max.y - half_h) {
+    cam->center.y = cam->world_max.y - half_h;
   }
 }
 
@@ -27,6 +28,8 @@ camera_t *camera_init(vector_t screen_min, vector_t screen_max) {
   camera_t *c = malloc(sizeof(camera_t));
   c->screen_min = screen_min;
   c->screen_max = screen_max;
+  c->world_min = screen_min;
+  c->world_max = screen_max;
   c->zoom = ZOOM_NORMAL;
 
   c->center.x = (screen_min.x + screen_max.x) * 0.5;
@@ -34,6 +37,22 @@ camera_t *camera_init(vector_t screen_min, vector_t screen_max) {
   return c;
 }
 
+void camera_set_bounds(camera_t *cam, vector_t world_min, vector_t world_max) {
+  cam->world_min = world_min;
+  cam->world_max = world_max;
+  cam->center.x = (world_min.x + world_max.x) * 0.5;
+  cam->center.y = (world_min.y + world_max.y) * 0.5;
+  clamp_center(cam);
+}
+
+void camera_get_view(const camera_t *cam, vector_t *view_min,
+                     vector_t *view_max) {
+  double half_w = (cam->screen_max.x - cam->screen_min.x) * 0.5 / cam->zoom;
+  double half_h = (cam->screen_max.y - cam->screen_min.y) * 0.5 / cam->zoom;
+  *view_min = (vector_t){cam->center.x - half_w, cam->center.y - half_h};
+  *view_max = (vector_t){cam->center.x + half_w, cam->center.y + half_h};
+}
+
 void camera_set_center(camera_t *cam, vector_t center) {
   cam->center = center;
   clamp_center(cam);
@@ -55,7 +74,12 @@ void camera_apply(const camera_t *cam) {
   int32_t ofs_x = ((win_w * 0.5) - (cam->center.x * cam->zoom));
   int32_t ofs_y = ((win_h * 0.5) - (cam->center.y * cam->zoom));
 
-  SDL_Rect vp = {ofs_x, ofs_y, win_w, win_h};
+  // The viewport also clips, and SDL scales it along with everything else.
+  // Stretch it so its far edges stay past the window's however far the
+  // camera has panned into a wide arena.
+  int32_t vp_w = fmax(win_w, win_w / cam->zoom - ofs_x);
+  int32_t vp_h = fmax(win_h, win_h / cam->zoom - ofs_y);
+  SDL_Rect vp = {ofs_x, ofs_y, vp_w, vp_h};
   SDL_RenderSetViewport(renderer, &vp);
 }
 
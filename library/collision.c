@@ -1,88 +1,69 @@
 #include "collision.h"
 #include "body.h"
-#include "list.h"
+#include "polygon.h"
 #include "vector.h"
 
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
-#include <string.h>
 
-/**
- * Returns a list of vectors representing the edges of a shape.
- *
- * @param shape the list of vectors representing the vertices of a shape
- * @return a list of vectors representing the edges of the shape
- */
-static list_t *get_edges(list_t *shape) {
-  list_t *edges = list_init(list_size(shape), free);
-
-  for (size_t i = 0; i < list_size(shape); i++) {
-    vector_t *vec = malloc(sizeof(vector_t));
-    assert(vec);
-    *vec =
-        vec_subtract(*(vector_t *)list_get(shape, i % list_size(shape)),
-                     *(vector_t *)list_get(shape, (i + 1) % list_size(shape)));
-    list_add(edges, vec);
-  }
-
-  return edges;
-}
+enum {
+  // vertices are projected onto an axis this many at a time
+  PROJECTION_BLOCK = 16
+};
 
 /**
  * Returns a vector containing the maximum and minimum length projections given
  * a unit axis and shape.
  *
- * @param shape the list of vectors representing the vertices of a shape
+ * @param shape the polygon to project
  * @param unit_axis the unit axis to project eeach vertex on
  * @return a vector in the form (max, min) where `max` is the maximum projection
  * length and `min` is the minimum projection length.
  */
-static vector_t get_max_min_projections(list_t *shape, vector_t unit_axis) {
+static vector_t get_max_min_projections(const polygon_t *shape,
+                                        vector_t unit_axis) {
+  const double *xs = polygon_xs(shape);
+  const double *ys = polygon_ys(shape);
+  size_t n = shape->num_vertices;
   double min = __DBL_MAX__;
   double max = -__DBL_MAX__;
 
-  size_t n = list_size(shape);
-  for (size_t i = 0; i < n; i++) {
-    vector_t *vec = list_get(shape, i);
-    double proj = vec_dot(*vec, unit_axis);
-    if (proj > max) {
-      max = proj;
-    }
-    if (proj < min) {
-      min = proj;
+  double projections[PROJECTION_BLOCK];
+  for (size_t first = 0; first < n; first += PROJECTION_BLOCK) {
+    size_t count = fmin(n - first, PROJECTION_BLOCK);
+    vec_batch_dot(xs + first, ys + first, count, unit_axis, projections);
+    for (size_t i = 0; i < count; i++) {
+      max = fmax(max, projections[i]);
+      min = fmin(min, projections[i]);
     }
   }
   return (vector_t){.x = max, .y = min};
 }
 
 /**
- * Determines whether two convex polygons intersect.
- * The polygons are given as lists of vertices in counterclockwise order.
- * There is an edge between each pair of consecutive vertices,
- * and one between the first vertex and the last vertex.
+ * Determines whether two convex polygons intersect, trying the precomputed
+ * edge normals of the first as separating axes.
  *
  * @param shape1 the first shape
  * @param shape2 the second shape
+ * @param min_overlap set to the smallest overlap found along shape1's axes
  * @return whether the shapes are colliding
  */
-static collision_info_t compare_collision(list_t *shape1, list_t *shape2,
+static collision_info_t compare_collision(const polygon_t *shape1,
+                                          const polygon_t *shape2,
                                           double *min_overlap) {
-  list_t *edges1 = get_edges(shape1);
   vector_t best_axis = VEC_ZERO;
 
-  size_t n = list_size(edges1);
-  for (size_t i = 0; i < n; i++) {
-    vector_t *edge = list_get(edges1, i);
-    vector_t axis = vec_rotate(*edge, M_PI / 2);
-
-    double axis_length = vec_get_length(axis);
-    vector_t unit_axis = vec_multiply(1 / axis_length, axis);
+  for (size_t i = 0; i < shape1->num_vertices; i++) {
+    vector_t unit_axis = polygon_normal(shape1, i);
+    if (unit_axis.x == 0 && unit_axis.y == 0) {
+      continue;
+    }
 
     vector_t projection_1 = get_max_min_projections(shape1, unit_axis);
     vector_t projection_2 = get_max_min_projections(shape2, unit_axis);
     if (projection_1.x < projection_2.y || projection_2.x < projection_1.y) {
-      list_free(edges1);
       return (collision_info_t){.collided = false, .axis = VEC_ZERO};
     }
     double overlap = fmin(projection_1.x, projection_2.x) -
@@ -94,27 +75,42 @@ static collision_info_t compare_collision(list_t *shape1, list_t *shape2,
   }
   // If we've reached this point, every pair of projections overlap, and thus
   // the polygons must collide.
-  list_free(edges1);
   return (collision_info_t){.collided = true, .axis = best_axis};
 }
 
+bool aabb_overlap(aabb_t box1, aabb_t box2) {
+  return box1.min.x <= box2.max.x && box2.min.x <= box1.max.x &&
+         box1.min.y <= box2.max.y && box2.min.y <= box1.max.y;
+}
+
+aabb_t aabb_sweep(aabb_t box, vector_t displacement) {
+  vector_t moved_min = vec_add(box.min, displacement);
+  vector_t moved_max = vec_add(box.max, displacement);
+  return (aabb_t){.min = {fmin(box.min.x, moved_min.x),
+                          fmin(box.min.y, moved_min.y)},
+                  .max = {fmax(box.max.x, moved_max.x),
+                          fmax(box.max.y, moved_max.y)}};
+}
+
 collision_info_t find_collision(body_t *body1, body_t *body2) {
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
+  if (!aabb_overlap(body_get_aabb(body1), body_get_aabb(body2))) {
+    return (collision_info_t){.collided = false, .axis = VEC_ZERO};
+  }
+
+  const polygon_t *shape1 = body_get_polygon(body1);
+  const polygon_t *shape2 = body_get_polygon(body2);
 
   double c1_overlap = __DBL_MAX__;
   double c2_overlap = __DBL_MAX__;
 
-  collision_info_t collision1 = compare_collision(shape1, shape2, &c1_overlap);
-  collision_info_t collision2 = compare_collision(shape2, shape1, &c2_overlap);
-
-  list_free(shape1);
-  list_free(shape2);
-
+  collision_info_t collision1 =
+      compare_collision(shape1, shape2, &c1_overlap);
   if (!collision1.collided) {
     return collision1;
   }
 
+  collision_info_t collision2 =
+      compare_collision(shape2, shape1, &c2_overlap);
   if (!collision2.collided) {
     return collision2;
   }
@@ -125,27 +121,184 @@ collision_info_t find_collision(body_t *body1, body_t *body2) {
   return collision2;
 }
 
+/**
+ * Casts every vertex of one polygon along a direction and finds the earliest
+ * point where any of them crosses an edge of another polygon.
+ *
+ * @param points the polygon whose vertices are cast
+ * @param dir the direction and length of the cast
+ * @param edges the polygon being cast against
+ * @param best the earliest hit found so far; updated if an earlier one is found
+ */
+static void cast_vertices(const polygon_t *points, vector_t dir,
+                          const polygon_t *edges,
+                          swept_collision_info_t *best) {
+  size_t n_points = points->num_vertices;
+  size_t n_edges = edges->num_vertices;
+  for (size_t j = 0; j < n_edges; j++) {
+    vector_t a = polygon_vertex(edges, j);
+    vector_t edge = vec_subtract(polygon_vertex(edges, (j + 1) % n_edges), a);
+    double denom = vec_cross(dir, edge);
+    if (denom == 0) {
+      continue;
+    }
+    for (size_t i = 0; i < n_points; i++) {
+      vector_t cast = polygon_vertex(points, i);
+      vector_t to_edge = vec_subtract(a, cast);
+      double t = vec_cross(to_edge, edge) / denom;
+      double s = vec_cross(to_edge, dir) / denom;
+      if (t < 0 || t > 1 || s < 0 || s > 1 || t >= best->time) {
+        continue;
+      }
+      best->collided = true;
+      best->time = t;
+      best->point = vec_add(cast, vec_multiply(t, dir));
+      best->axis = polygon_normal(edges, j);
+    }
+  }
+}
+
+swept_collision_info_t find_swept_collision(body_t *body1,
+                                            vector_t displacement,
+                                            body_t *body2) {
+  aabb_t swept_box = aabb_sweep(body_get_aabb(body1), displacement);
+  if (!aabb_overlap(swept_box, body_get_aabb(body2))) {
+    return (swept_collision_info_t){.collided = false};
+  }
+
+  collision_info_t overlap = find_collision(body1, body2);
+  if (overlap.collided) {
+    return (swept_collision_info_t){.collided = true,
+                                    .time = 0,
+                                    .point = body_get_centroid(body1),
+                                    .axis = overlap.axis};
+  }
+
+  const polygon_t *shape1 = body_get_polygon(body1);
+  const polygon_t *shape2 = body_get_polygon(body2);
+
+  // Two translating convex polygons first touch vertex-to-edge, so it is
+  // enough to cast body1's vertices forwards against body2's edges and
+  // body2's vertices backwards against body1's edges.
+  swept_collision_info_t best = {.collided = false, .time = __DBL_MAX__};
+  cast_vertices(shape1, displacement, shape2, &best);
+
+  swept_collision_info_t reverse = {.collided = false, .time = best.time};
+  cast_vertices(shape2, vec_negate(displacement), shape1, &reverse);
+  if (reverse.collided) {
+    // body2 does not move, so the contact point is the vertex itself
+    reverse.point =
+        vec_add(reverse.point, vec_multiply(reverse.time, displacement));
+    best = reverse;
+  }
+
+  if (best.collided && vec_dot(best.axis, displacement) < 0) {
+    best.axis = vec_negate(best.axis);
+  }
+  return best;
+}
+
+/**
+ * Determines whether a unit axis separates a polygon sweeping along a
+ * displacement from a stationary one. The sweep's projection is the moving
+ * polygon's projection stretched by the displacement's projection.
+ *
+ * @param shape1 the moving shape
+ * @param displacement how far the moving shape travels
+ * @param shape2 the stationary shape
+ * @param unit_axis the axis to project onto
+ * @return whether the projections are disjoint
+ */
+static bool sweep_separated_on(const polygon_t *shape1, vector_t displacement,
+                               const polygon_t *shape2, vector_t unit_axis) {
+  vector_t projection_1 = get_max_min_projections(shape1, unit_axis);
+  vector_t projection_2 = get_max_min_projections(shape2, unit_axis);
+  double shift = vec_dot(displacement, unit_axis);
+  projection_1.x += fmax(shift, 0);
+  projection_1.y += fmin(shift, 0);
+  return projection_1.x < projection_2.y || projection_2.x < projection_1.y;
+}
+
+/**
+ * Tries the edge normals of one polygon as separating axes for a sweep.
+ *
+ * @param edges the polygon whose edge normals are tried
+ * @param shape1 the moving shape
+ * @param displacement how far the moving shape travels
+ * @param shape2 the stationary shape
+ * @param axis set to the first separating normal, if one is found
+ * @return whether one of the normals separates the shapes
+ */
+static bool find_separating_normal(const polygon_t *edges,
+                                   const polygon_t *shape1,
+                                   vector_t displacement,
+                                   const polygon_t *shape2, vector_t *axis) {
+  for (size_t i = 0; i < edges->num_vertices; i++) {
+    vector_t normal = polygon_normal(edges, i);
+    if (normal.x == 0 && normal.y == 0) {
+      continue;
+    }
+    if (sweep_separated_on(shape1, displacement, shape2, normal)) {
+      *axis = normal;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool is_separating_axis(body_t *body1, vector_t displacement, body_t *body2,
+                        vector_t axis) {
+  return sweep_separated_on(body_get_polygon(body1), displacement,
+                            body_get_polygon(body2), axis);
+}
+
+bool find_separating_axis(body_t *body1, vector_t displacement, body_t *body2,
+                          vector_t *axis) {
+  const polygon_t *shape1 = body_get_polygon(body1);
+  const polygon_t *shape2 = body_get_polygon(body2);
+
+  // The region body1 sweeps through is the convex hull of its start and end
+  // positions, whose edges are body1's own edges plus two parallel to the
+  // displacement. Those normals and body2's are every candidate SAT needs.
+  if (find_separating_normal(shape1, shape1, displacement, shape2, axis) ||
+      find_separating_normal(shape2, shape1, displacement, shape2, axis)) {
+    return true;
+  }
+  double length = vec_get_length(displacement);
+  if (length == 0) {
+    return false;
+  }
+  vector_t normal = {.x = -displacement.y / length,
+                     .y = displacement.x / length};
+  if (sweep_separated_on(shape1, displacement, shape2, normal)) {
+    *axis = normal;
+    return true;
+  }
+  return false;
+}
+
 vector_t min_point_of_body(body_t *body) {
-  list_t *shape = body_get_shape(body);
-  vector_t min_point = *(vector_t *)list_get(shape, 0);
-  size_t n = list_size(shape);
+  const polygon_t *polygon = body_get_polygon(body);
+  const double *ys = polygon_ys(polygon);
+  size_t n = polygon->num_vertices;
+  size_t lowest = 0;
   for (size_t i = 1; i < n; i++) {
-    vector_t pt = (*(vector_t *)list_get(shape, i));
-    if (pt.y < min_point.y) {
-      min_point.y = pt.y;
-      min_point.x = pt.x;
+    if (ys[i] < ys[lowest]) {
+      lowest = i;
     }
   }
-  list_free(shape);
-  return min_point;
+  return polygon_vertex(polygon, lowest);
 }
 
 bool alt_check_collision_certain_body(level_t *level, body_t *body,
-                                      const char *required_info) {
-  vector_t min_pt = min_point_of_body(body);
-  if (min_pt.y <= level_ground_height(level, min_pt.x) &&
-      strcmp(body_get_info(body), required_info) == 0) {
-    return true;
+                                      body_kind_t required_kind) {
+  if (body_get_kind(body) != required_kind) {
+    return false;
   }
-  return false;
-}
\ No newline at end of file
+  // nothing whose box is above the highest point of the terrain can touch it
+  if (body_get_aabb(body).min.y > level->max_ground_height) {
+    return false;
+  }
+  vector_t min_pt = min_point_of_body(body);
+  return min_pt.y <= level_ground_height(level, min_pt.x);
+}
@@ -0,0 +1,16 @@
+#include "color.h"
+
+#include <stdlib.h>
+
+/**
+ * Picks a color channel uniformly between 0 and 1.
+ */
+static double random_channel(void) { return (double)rand() / RAND_MAX; }
+
+color_t color_get_random() {
+  return (color_t){random_channel(), random_channel(), random_channel()};
+}
+
+bool color_is_equal(color_t c1, color_t c2) {
+  return c1.red == c2.red && c1.green == c2.green && c1.blue == c2.blue;
+}
@@ -0,0 +1,188 @@
+#include "contact_cache.h"
+#include "body.h"
+#include "collision.h"
+#include "vector.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+const size_t CONTACT_CACHE_INIT_CAPACITY = 16;
+
+typedef struct {
+  // ordered by address, so either argument order finds the same entry
+  body_t *body1;
+  body_t *body2;
+  vector_t axis;
+  bool has_axis;
+  bool touching;
+  bool seen;
+} contact_t;
+
+typedef struct contact_cache {
+  contact_t *contacts;
+  size_t count;
+  size_t capacity;
+  // open-addressed hash index into `contacts`, storing index + 1 (0 is empty)
+  size_t *slots;
+  size_t num_slots;
+} contact_cache_t;
+
+/**
+ * Hashes an ordered body pair.
+ */
+static size_t hash_pair(body_t *body1, body_t *body2) {
+  uint64_t h = (uint64_t)(uintptr_t)body1 * 0x9E3779B97F4A7C15ULL;
+  h ^= (uint64_t)(uintptr_t)body2 + 0x632BE59BD9B4E019ULL + (h << 6) + (h >> 2);
+  return (size_t)(h ^ (h >> 32));
+}
+
+/**
+ * Inserts the contact at a given index into the hash index.
+ * The index must have a free slot.
+ */
+static void index_contact(contact_cache_t *cache, size_t i) {
+  contact_t *c = &cache->contacts[i];
+  size_t mask = cache->num_slots - 1;
+  size_t slot = hash_pair(c->body1, c->body2) & mask;
+  while (cache->slots[slot] != 0) {
+    slot = (slot + 1) & mask;
+  }
+  cache->slots[slot] = i + 1;
+}
+
+/**
+ * Rebuilds the hash index from scratch, sized to keep it at most half full.
+ */
+static void rebuild_index(contact_cache_t *cache) {
+  size_t wanted = 2 * cache->capacity;
+  if (wanted != cache->num_slots) {
+    free(cache->slots);
+    cache->slots = malloc(sizeof(size_t) * wanted);
+    assert(cache->slots);
+    cache->num_slots = wanted;
+  }
+  for (size_t i = 0; i < cache->num_slots; i++) {
+    cache->slots[i] = 0;
+  }
+  for (size_t i = 0; i < cache->count; i++) {
+    index_contact(cache, i);
+  }
+}
+
+/**
+ * Finds the entry for a pair of bodies, adding a fresh one if the pair has
+ * not been tested since it was last dropped.
+ */
+static contact_t *get_contact(contact_cache_t *cache, body_t *body1,
+                              body_t *body2) {
+  if ((uintptr_t)body2 < (uintptr_t)body1) {
+    body_t *temp = body1;
+    body1 = body2;
+    body2 = temp;
+  }
+
+  size_t mask = cache->num_slots - 1;
+  size_t slot = hash_pair(body1, body2) & mask;
+  while (cache->slots[slot] != 0) {
+    contact_t *c = &cache->contacts[cache->slots[slot] - 1];
+    if (c->body1 == body1 && c->body2 == body2) {
+      return c;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  if (cache->count == cache->capacity) {
+    cache->capacity *= 2;
+    cache->contacts =
+        realloc(cache->contacts, sizeof(contact_t) * cache->capacity);
+    assert(cache->contacts);
+    cache->contacts[cache->count] = (contact_t){.body1 = body1,
+                                                .body2 = body2};
+    cache->count++;
+    rebuild_index(cache);
+  } else {
+    cache->contacts[cache->count] = (contact_t){.body1 = body1,
+                                                .body2 = body2};
+    cache->slots[slot] = cache->count + 1;
+    cache->count++;
+  }
+  return &cache->contacts[cache->count - 1];
+}
+
+contact_cache_t *contact_cache_init(void) {
+  contact_cache_t *cache = malloc(sizeof(contact_cache_t));
+  assert(cache);
+  cache->contacts = malloc(sizeof(contact_t) * CONTACT_CACHE_INIT_CAPACITY);
+  assert(cache->contacts);
+  cache->count = 0;
+  cache->capacity = CONTACT_CACHE_INIT_CAPACITY;
+  cache->slots = NULL;
+  cache->num_slots = 0;
+  rebuild_index(cache);
+  return cache;
+}
+
+contact_state_t contact_cache_sweep(contact_cache_t *cache, body_t *body1,
+                                    vector_t displacement, body_t *body2,
+                                    swept_collision_info_t *hit) {
+  contact_t *c = get_contact(cache, body1, body2);
+  bool was_touching = c->touching;
+  c->seen = true;
+  *hit = (swept_collision_info_t){.collided = false};
+
+  if (!(c->has_axis &&
+        is_separating_axis(body1, displacement, body2, c->axis))) {
+    aabb_t box1 = aabb_sweep(body_get_aabb(body1), displacement);
+    aabb_t box2 = body_get_aabb(body2);
+    if (!aabb_overlap(box1, box2)) {
+      // disjoint boxes are separated along whichever world axis they miss on
+      bool apart_in_x = box1.max.x < box2.min.x || box2.max.x < box1.min.x;
+      c->axis = apart_in_x ? (vector_t){1, 0} : (vector_t){0, 1};
+      c->has_axis = true;
+    } else if (find_separating_axis(body1, displacement, body2, &c->axis)) {
+      c->has_axis = true;
+    } else {
+      *hit = find_swept_collision(body1, displacement, body2);
+      if (hit->collided) {
+        c->axis = hit->axis;
+        c->has_axis = true;
+      }
+    }
+  }
+  c->touching = hit->collided;
+
+  if (c->touching) {
+    return was_touching ? CONTACT_STAY : CONTACT_ENTER;
+  }
+  return was_touching ? CONTACT_EXIT : CONTACT_NONE;
+}
+
+void contact_cache_end_tick(contact_cache_t *cache,
+                            contact_exit_handler_t on_exit, void *aux) {
+  size_t kept = 0;
+  for (size_t i = 0; i < cache->count; i++) {
+    contact_t c = cache->contacts[i];
+    if (!c.seen || body_is_removed(c.body1) || body_is_removed(c.body2)) {
+      if (c.touching && on_exit) {
+        on_exit(c.body1, c.body2, aux);
+      }
+      continue;
+    }
+    c.seen = false;
+    cache->contacts[kept] = c;
+    kept++;
+  }
+  // entries only move when some were dropped, so otherwise the index still
+  // points at the right places
+  if (kept < cache->count) {
+    cache->count = kept;
+    rebuild_index(cache);
+  }
+}
+
+void contact_cache_free(contact_cache_t *cache) {
+  free(cache->contacts);
+  free(cache->slots);
+  free(cache);
+}
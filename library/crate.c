@@ -8,27 +8,41 @@
 #include <string.h>
 
 const double CRATE_SIZE = 64.0;
-const double MARGIN = CRATE_SIZE * 2.0;
 const double CRATE_MASS = INFINITY;
 const int32_t CRATE_HP = 30;
 const char *CRATE_IMG = "assets/crate.png";
-const size_t CRATE_NUM_POINTS = 4;
 const color_t CRATE_COLOR = {1, 1, 1};
 const double LABEL_OFFSET = 12.0;
-const char *CRATE_TAG = "crate";
 const char *FONT_PATH = "assets/Arial.ttf";
 const size_t CRATE_HUD_PX = 20;
 const size_t TEXT_WIDTH = 50;
 
-bool crate_is(body_t *b) {
-  if (!b) {
-    return false;
+enum { CRATE_NUM_POINTS = 4 };
+
+/**
+ * The box shared by every crate, built on first use and kept for the life
+ * of the program.
+ */
+static shape_t *CRATE_SHAPE = NULL;
+
+/**
+ * @return the box shared by every crate, centered on the origin
+ */
+static shape_t *crate_shape(void) {
+  if (!CRATE_SHAPE) {
+    vector_t verts[CRATE_NUM_POINTS];
+    for (size_t i = 0; i < CRATE_NUM_POINTS; i++) {
+      double x_side = (i == 1 || i == 2) ? 1 : -1;
+      double y_side = (i >= 2) ? 1 : -1;
+      verts[i] = (vector_t){x_side * CRATE_SIZE * .5, y_side * CRATE_SIZE * .5};
+    }
+    CRATE_SHAPE = shape_init(verts, CRATE_NUM_POINTS, NULL);
   }
-  color_t color = body_get_color(b);
-  return CRATE_COLOR.red == color.red && CRATE_COLOR.green == color.green &&
-         CRATE_COLOR.blue == color.blue;
+  return CRATE_SHAPE;
 }
 
+bool crate_is(body_t *b) { return b && body_get_kind(b) == BODY_CRATE; }
+
 body_t *crate_spawn(level_t *level) {
   scene_t *scene = level->scene;
   size_t n = scene_bodies(scene);
@@ -38,32 +52,31 @@ body_t *crate_spawn(level_t *level) {
     }
   }
 
-  double min_x = level->info.screen_min.x + MARGIN;
-  double max_x = level->info.screen_max.x - MARGIN;
-  double x = rand_double(min_x, max_x);
+  size_t num_zones = level->file->header->num_crate_zones;
+  if (num_zones == 0) {
+    return NULL;
+  }
+  level_zone_t zone = level->file->crate_zones[rand() % num_zones];
+  double x = rand_double(zone.min_x, zone.max_x);
   double y_0 = level_ground_height(level, x);
 
   vector_t center = {x, y_0 + CRATE_SIZE * 0.5};
-  list_t *verts = list_init(CRATE_NUM_POINTS, free);
-  for (size_t i = 0; i < CRATE_NUM_POINTS; i++) {
-    double x_side = (i == 1 || i == 2) ? 1 : -1;
-    double y_side = (i >= 2) ? 1 : -1;
-    vector_t *vertex = malloc(sizeof(vector_t));
-    *vertex = (vector_t){center.x + x_side * CRATE_SIZE * .5,
-                         center.y + y_side * CRATE_SIZE * .5};
-    list_add(verts, vertex);
-  }
-
   crate_info_t *info = malloc(sizeof(crate_info_t));
-  *info = (crate_info_t){.tag = CRATE_TAG, .hp = CRATE_HP};
+  *info = (crate_info_t){.hp = CRATE_HP};
 
-  body_t *crate =
-      body_init_with_info(verts, CRATE_MASS, CRATE_COLOR, info, free);
-  asset_make_image_with_body(CRATE_IMG, crate);
-  scene_add_body(scene, crate);
+  body_t *crate = body_init_with_shape(crate_shape(), center, CRATE_MASS,
+                                       CRATE_COLOR, info, free);
+  body_set_kind(crate, BODY_CRATE);
+  body_set_collision_filter(crate, LAYER_TARGET, LAYER_PROJECTILE);
+  level_add_body(level, crate);
   return crate;
 }
 
+void crate_add_sprite(body_t *crate) {
+  body_set_render_layers(crate, RENDER_SPRITE);
+  asset_make_image_with_body(CRATE_IMG, crate);
+}
+
 void crate_render_hp(scene_t *scene, camera_t *cam, const char *font_path,
                      const color_t color) {
   size_t n = scene_bodies(scene);
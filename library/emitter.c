@@ -0,0 +1,88 @@
+#include "emitter.h"
+
+#include <assert.h>
+#include <math.h>
+
+const effect_def_t EFFECT_DEFS[NUM_EFFECTS] = {
+    [EFFECT_TRAIL] = {.rate = 120,
+                      .burst_count = 1,
+                      .lifetime = 0.8,
+                      .size = 3,
+                      .weight = 0,
+                      .spread = M_PI,
+                      .min_speed = 0,
+                      .max_speed = 20,
+                      .inherit = 0.3,
+                      .color = {1, 0.392, 0.392}},
+    [EFFECT_DUST] = {.rate = 0,
+                     .burst_count = 20,
+                     .lifetime = 3.0,
+                     .size = 5,
+                     .weight = 1,
+                     .spread = M_PI / 2,
+                     .min_speed = 20,
+                     .max_speed = 100,
+                     .inherit = 0,
+                     .color = {0.47, 0.17, 0.137}},
+    [EFFECT_SPLINTERS] = {.rate = 0,
+                          .burst_count = 12,
+                          .lifetime = 3.0,
+                          .size = 4,
+                          .weight = 1,
+                          .spread = M_PI / 3,
+                          .min_speed = 60,
+                          .max_speed = 180,
+                          .inherit = 0,
+                          .color = {0.6, 0.42, 0.2}}};
+
+const effect_def_t *emitter_effect_def(effect_t effect) {
+  assert(effect < NUM_EFFECTS);
+  return &EFFECT_DEFS[effect];
+}
+
+/**
+ * Adds one particle of an effect, thrown in a random direction within the
+ * effect's spread.
+ *
+ * @param pool the pool to add the particle to
+ * @param def the effect
+ * @param pos where the particle starts
+ * @param vel the velocity of the thing emitting
+ * @param dir the unit direction the particle is thrown in
+ */
+static void emit_one(particle_pool_t *pool, const effect_def_t *def,
+                     vector_t pos, vector_t vel, vector_t dir) {
+  double theta = particle_pool_random(pool, -def->spread, def->spread);
+  double speed = particle_pool_random(pool, def->min_speed, def->max_speed);
+  double c = cos(theta);
+  double s = sin(theta);
+  vector_t thrown = {speed * (dir.x * c - dir.y * s),
+                     speed * (dir.x * s + dir.y * c)};
+  vector_t particle_vel = vec_add(vec_multiply(def->inherit, vel), thrown);
+  particle_pool_emit(pool, pos, particle_vel, def->lifetime, def->size,
+                     def->weight, def->color);
+}
+
+void emitter_init(emitter_t *emitter, effect_t effect) {
+  assert(effect < NUM_EFFECTS);
+  emitter->effect = effect;
+  emitter->due = 0;
+}
+
+void emitter_update(emitter_t *emitter, particle_pool_t *pool, double dt,
+                    vector_t pos, vector_t vel, vector_t dir) {
+  const effect_def_t *def = &EFFECT_DEFS[emitter->effect];
+  emitter->due += def->rate * dt;
+  while (emitter->due >= 1) {
+    emit_one(pool, def, pos, vel, dir);
+    emitter->due -= 1;
+  }
+}
+
+void emitter_burst(particle_pool_t *pool, effect_t effect, vector_t pos,
+                   vector_t dir) {
+  const effect_def_t *def = emitter_effect_def(effect);
+  for (size_t i = 0; i < def->burst_count; i++) {
+    emit_one(pool, def, pos, VEC_ZERO, dir);
+  }
+}
@@ -0,0 +1,45 @@
+#include "fixed_step.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+typedef struct fixed_step {
+  double dt;
+  size_t max_steps;
+  // time that has passed but not yet been simulated
+  double accumulator;
+} fixed_step_t;
+
+fixed_step_t *fixed_step_init(double rate, size_t max_steps) {
+  assert(rate > 0);
+  assert(max_steps > 0);
+  fixed_step_t *stepper = malloc(sizeof(fixed_step_t));
+  assert(stepper);
+  stepper->dt = 1 / rate;
+  stepper->max_steps = max_steps;
+  stepper->accumulator = 0;
+  return stepper;
+}
+
+double fixed_step_dt(const fixed_step_t *stepper) { return stepper->dt; }
+
+size_t fixed_step_advance(fixed_step_t *stepper, double frame_dt) {
+  stepper->accumulator += frame_dt;
+  size_t steps = 0;
+  while (stepper->accumulator >= stepper->dt && steps < stepper->max_steps) {
+    stepper->accumulator -= stepper->dt;
+    steps++;
+  }
+  if (steps == stepper->max_steps) {
+    // drop the whole steps that did not fit, keeping the fraction
+    stepper->accumulator = fmod(stepper->accumulator, stepper->dt);
+  }
+  return steps;
+}
+
+double fixed_step_alpha(const fixed_step_t *stepper) {
+  return stepper->accumulator / stepper->dt;
+}
+
+void fixed_step_free(fixed_step_t *stepper) { free(stepper); }
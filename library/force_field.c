@@ -0,0 +1,54 @@
+#include "force_field.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t FIELD_ZONE_INIT_CAPACITY = 4;
+
+force_field_t *force_field_init(vector_t gravity, double drag) {
+  force_field_t *field = malloc(sizeof(force_field_t));
+  assert(field);
+  field->gravity = gravity;
+  field->wind = VEC_ZERO;
+  field->drag = drag;
+  field->zones = NULL;
+  field->num_zones = 0;
+  field->zone_capacity = 0;
+  return field;
+}
+
+void force_field_add_zone(force_field_t *field, aabb_t region,
+                          vector_t accel) {
+  if (field->num_zones == field->zone_capacity) {
+    field->zone_capacity = field->zone_capacity ? field->zone_capacity * 2
+                                                : FIELD_ZONE_INIT_CAPACITY;
+    field->zones =
+        realloc(field->zones, sizeof(field_zone_t) * field->zone_capacity);
+    assert(field->zones);
+  }
+  field->zones[field->num_zones] =
+      (field_zone_t){.region = region, .accel = accel};
+  field->num_zones++;
+}
+
+vector_t force_field_accel(vector_t pos, vector_t vel, void *aux) {
+  const force_field_t *field = aux;
+  double k = field->drag * sqrt(vel.x * vel.x + vel.y * vel.y);
+  vector_t accel = {field->gravity.x + field->wind.x - k * vel.x,
+                    field->gravity.y + field->wind.y - k * vel.y};
+  for (size_t i = 0; i < field->num_zones; i++) {
+    const field_zone_t *zone = &field->zones[i];
+    if (pos.x >= zone->region.min.x && pos.x <= zone->region.max.x &&
+        pos.y >= zone->region.min.y && pos.y <= zone->region.max.y) {
+      accel.x += zone->accel.x;
+      accel.y += zone->accel.y;
+    }
+  }
+  return accel;
+}
+
+void force_field_free(force_field_t *field) {
+  free(field->zones);
+  free(field);
+}
@@ -0,0 +1,160 @@
+#include "heightfield.h"
+#include "vector.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <math.h>
+#include <stdlib.h>
+
+typedef struct heightfield {
+  double min_x;
+  double dx;
+  double inv_dx;
+  // just short of the last sample index, so a clamped lookup always has a
+  // sample to its right
+  double max_u;
+  size_t num_samples;
+  double max_height;
+  double *heights;
+  vector_t *normals;
+  // false if the sample arrays were passed to heightfield_wrap()
+  bool owns_samples;
+} heightfield_t;
+
+/**
+ * Computes the unit normal at a sample from the slope to its neighbours.
+ */
+static vector_t sample_normal(const heightfield_t *hf, size_t i) {
+  size_t left = i > 0 ? i - 1 : i;
+  size_t right = i + 1 < hf->num_samples ? i + 1 : i;
+  vector_t normal = {.x = -(hf->heights[right] - hf->heights[left]),
+                     .y = (right - left) * hf->dx};
+  return vec_multiply(1 / vec_get_length(normal), normal);
+}
+
+/**
+ * Splits an x position into the index of the sample to its left and the
+ * fraction of the way to the next sample, clamped to the sampled range.
+ */
+static size_t locate(const heightfield_t *hf, double x, double *frac) {
+  double u = fmin(fmax((x - hf->min_x) * hf->inv_dx, 0), hf->max_u);
+  size_t i = (size_t)u;
+  *frac = u - i;
+  return i;
+}
+
+heightfield_t *heightfield_init(double min_x, double max_x, double dx,
+                                height_func_t height, void *aux) {
+  heightfield_t *hf = malloc(sizeof(heightfield_t));
+  assert(hf);
+  hf->min_x = min_x;
+  hf->dx = dx;
+  hf->inv_dx = 1 / dx;
+  hf->num_samples = (size_t)fmax(ceil((max_x - min_x) / dx) + 1, 2);
+  hf->max_u = nextafter((double)(hf->num_samples - 1), 0);
+  hf->heights = malloc(sizeof(double) * hf->num_samples);
+  assert(hf->heights);
+  hf->normals = malloc(sizeof(vector_t) * hf->num_samples);
+  assert(hf->normals);
+  hf->owns_samples = true;
+
+  hf->max_height = -__DBL_MAX__;
+  for (size_t i = 0; i < hf->num_samples; i++) {
+    hf->heights[i] = height(min_x + i * dx, aux);
+    hf->max_height = fmax(hf->max_height, hf->heights[i]);
+  }
+  for (size_t i = 0; i < hf->num_samples; i++) {
+    hf->normals[i] = sample_normal(hf, i);
+  }
+  return hf;
+}
+
+heightfield_t *heightfield_wrap(double min_x, double dx, size_t num_samples,
+                                double *heights, vector_t *normals,
+                                double max_height) {
+  assert(num_samples >= 2);
+  heightfield_t *hf = malloc(sizeof(heightfield_t));
+  assert(hf);
+  hf->min_x = min_x;
+  hf->dx = dx;
+  hf->inv_dx = 1 / dx;
+  hf->num_samples = num_samples;
+  hf->max_u = nextafter((double)(num_samples - 1), 0);
+  hf->max_height = max_height;
+  hf->heights = heights;
+  hf->normals = normals;
+  hf->owns_samples = false;
+  return hf;
+}
+
+void heightfield_get_samples(const heightfield_t *hf, double *min_x,
+                             double *dx, size_t *num_samples,
+                             const double **heights,
+                             const vector_t **normals) {
+  *min_x = hf->min_x;
+  *dx = hf->dx;
+  *num_samples = hf->num_samples;
+  *heights = hf->heights;
+  *normals = hf->normals;
+}
+
+double heightfield_height(const heightfield_t *hf, double x) {
+  double frac;
+  size_t i = locate(hf, x, &frac);
+  return hf->heights[i] + frac * (hf->heights[i + 1] - hf->heights[i]);
+}
+
+vector_t heightfield_normal(const heightfield_t *hf, double x) {
+  double frac;
+  size_t i = locate(hf, x, &frac);
+  vector_t normal = vec_add(vec_multiply(1 - frac, hf->normals[i]),
+                            vec_multiply(frac, hf->normals[i + 1]));
+  return vec_multiply(1 / vec_get_length(normal), normal);
+}
+
+void heightfield_heights(const heightfield_t *hf, const double *xs,
+                         double *heights, size_t n) {
+  const double *samples = hf->heights;
+  for (size_t k = 0; k < n; k++) {
+    double frac;
+    size_t i = locate(hf, xs[k], &frac);
+    heights[k] = samples[i] + frac * (samples[i + 1] - samples[i]);
+  }
+}
+
+void heightfield_carve(heightfield_t *hf, vector_t center, double radius) {
+  double last = (double)(hf->num_samples - 1);
+  double left = (center.x - radius - hf->min_x) * hf->inv_dx;
+  double right = (center.x + radius - hf->min_x) * hf->inv_dx;
+  double first_u = fmax(ceil(left), 0);
+  double last_u = fmin(floor(right), last);
+  if (first_u > last_u) {
+    return;
+  }
+  size_t first = (size_t)first_u;
+  size_t end = (size_t)last_u + 1;
+
+  for (size_t i = first; i < end; i++) {
+    double dx = hf->min_x + i * hf->dx - center.x;
+    double bottom = center.y - sqrt(fmax(radius * radius - dx * dx, 0));
+    hf->heights[i] = fmin(hf->heights[i], bottom);
+  }
+  // a sample's normal depends on its neighbours' heights too
+  size_t normals_first = first > 0 ? first - 1 : first;
+  size_t normals_end = end < hf->num_samples ? end + 1 : end;
+  for (size_t i = normals_first; i < normals_end; i++) {
+    hf->normals[i] = sample_normal(hf, i);
+  }
+}
+
+double heightfield_max_height(const heightfield_t *hf) {
+  return hf->max_height;
+}
+
+void heightfield_free(heightfield_t *hf) {
+  if (hf->owns_samples) {
+    free(hf->heights);
+    free(hf->normals);
+  }
+  free(hf);
+}
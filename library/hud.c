@@ -52,7 +52,7 @@ void hud_draw(turn_engine_t *eng) {
   asset_make_text(HUD_FONT_PATH, rect, time, HUD_COLOR);
 
   char wind_mag_msg[64];
-  vector_t wind = eng->level->wind;
+  vector_t wind = eng->level->field->wind;
   double wind_mag = vec_get_length(wind);
   const char *msg;
   if (wind_mag >= WIND_THRESH_STRONG) {
@@ -0,0 +1,84 @@
+#include "integrator.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+
+const size_t MAX_SUBSTEPS = 16;
+
+vector_t integrator_constant_accel(vector_t pos, vector_t vel, void *aux) {
+  return *(vector_t *)aux;
+}
+
+/**
+ * Takes a velocity Verlet step. The velocity the new acceleration is
+ * sampled at is predicted with the old acceleration.
+ */
+static void verlet_step(vector_t *pos, vector_t *vel, double dt,
+                        accel_func_t accel, void *aux) {
+  vector_t a0 = accel(*pos, *vel, aux);
+  vector_t x1 = vec_add(*pos, vec_add(vec_multiply(dt, *vel),
+                                      vec_multiply(0.5 * dt * dt, a0)));
+  vector_t v_guess = vec_add(*vel, vec_multiply(dt, a0));
+  vector_t a1 = accel(x1, v_guess, aux);
+  *vel = vec_add(*vel, vec_multiply(0.5 * dt, vec_add(a0, a1)));
+  *pos = x1;
+}
+
+/**
+ * Takes a fourth-order Runge-Kutta step of the system x' = v, v' = a(x, v).
+ */
+static void rk4_step(vector_t *pos, vector_t *vel, double dt,
+                     accel_func_t accel, void *aux) {
+  vector_t x = *pos;
+  vector_t v = *vel;
+
+  vector_t k1x = v;
+  vector_t k1v = accel(x, v, aux);
+
+  vector_t k2x = vec_add(v, vec_multiply(0.5 * dt, k1v));
+  vector_t k2v = accel(vec_add(x, vec_multiply(0.5 * dt, k1x)), k2x, aux);
+
+  vector_t k3x = vec_add(v, vec_multiply(0.5 * dt, k2v));
+  vector_t k3v = accel(vec_add(x, vec_multiply(0.5 * dt, k2x)), k3x, aux);
+
+  vector_t k4x = vec_add(v, vec_multiply(dt, k3v));
+  vector_t k4v = accel(vec_add(x, vec_multiply(dt, k3x)), k4x, aux);
+
+  vector_t dx = vec_add(vec_add(k1x, k4x), vec_multiply(2, vec_add(k2x, k3x)));
+  vector_t dv = vec_add(vec_add(k1v, k4v), vec_multiply(2, vec_add(k2v, k3v)));
+  *pos = vec_add(x, vec_multiply(dt / 6, dx));
+  *vel = vec_add(v, vec_multiply(dt / 6, dv));
+}
+
+void integrator_step(integrator_t method, vector_t *pos, vector_t *vel,
+                     double dt, accel_func_t accel, void *aux) {
+  switch (method) {
+  case INTEGRATOR_SEMI_IMPLICIT_EULER:
+    *vel = vec_add(*vel, vec_multiply(dt, accel(*pos, *vel, aux)));
+    *pos = vec_add(*pos, vec_multiply(dt, *vel));
+    break;
+  case INTEGRATOR_VELOCITY_VERLET:
+    verlet_step(pos, vel, dt, accel, aux);
+    break;
+  case INTEGRATOR_RK4:
+    rk4_step(pos, vel, dt, accel, aux);
+    break;
+  default:
+    assert(false && "unknown integrator");
+  }
+}
+
+void integrator_advance(integrator_t method, vector_t *pos, vector_t *vel,
+                        double dt, double max_travel, accel_func_t accel,
+                        void *aux) {
+  double travel = vec_get_length(*vel) * dt;
+  size_t substeps = 1;
+  if (travel > max_travel) {
+    substeps = fmin(ceil(travel / max_travel), MAX_SUBSTEPS);
+  }
+  double h = dt / substeps;
+  for (size_t i = 0; i < substeps; i++) {
+    integrator_step(method, pos, vel, h, accel, aux);
+  }
+}
@@ -1,180 +1,447 @@
 #include "level.h"
 #include "arrow.h"
-#include "asset.h"
 #include "camera.h"
-#include "forces.h"
+#include "contact_cache.h"
+#include "level_file.h"
 #include "sdl_wrapper.h"
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-// arena constants
-const size_t NUM_ARENA_VERTICES = 60;
 const size_t NUM_WALL_VERITCES = 2;
-const size_t ARENA_HEIGHT = 100;
 const double IMMOVABLE_MASS = INFINITY;
-const char *GROUND_INFO = "ground";
 
-const double FOREST_HILL_HEIGHT = 90.0;
-const double FOREST_HILL_HALFWIDTH = 180.0;
+const size_t GROUND_CHUNK_EDGES = 16;
+const integrator_t ARROW_INTEGRATOR = INTEGRATOR_RK4;
+// about an arrow's length, so no substep skips past a whole arrow
+const double ARROW_MAX_STEP_TRAVEL = 32;
+// room for trail and impact particles is made for this many up front, and
+// grows up to the budget; past that, new particles replace the oldest
+const size_t PARTICLE_CAPACITY = 1024;
+const size_t PARTICLE_BUDGET = 16384;
+// the most freed bodies of each kind kept for reuse
+const size_t MAX_SPARE_BODIES = 64;
 
-const double MESA_TOP_HEIGHT = 80.0;
-const double MESA_LOW_HEIGHT = 0;
-const double MESA_CLIFF_RATIO = 0.45;
-const double MESA_CLIFF_WIDTH = 10;
-
-const double MOON_CRATER_DEPTH = 80.0;
-const double MOON_CRATER_HALFWIDTH = 200.0;
-const double MOON_LIP_HEIGHT = 75.0;
-const double MOON_LIP_OFFSET = 260.0;
-const double MOON_LIP_HALFWIDTH = 60.0;
-
-const size_t IMPACT_BURST_COUNT = 20;
+/**
+ * Finds the first ground surface vertex at or to the right of an x position.
+ *
+ * @param file the mapped level file
+ * @param x the x position in world coordinates
+ * @return the index of the vertex, or the number of vertices if there is none
+ */
+static size_t first_vertex_at(const level_file_t *file, double x) {
+  size_t lo = 0;
+  size_t hi = file->header->num_ground_vertices;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (file->ground_vertices[mid].x < x) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
 
-double forest_height(double x, double w) {
-  return ARENA_HEIGHT +
-         FOREST_HILL_HEIGHT *
-             exp(-pow((x - 0.5 * w) / FOREST_HILL_HALFWIDTH, 2.0));
+/**
+ * Finds the ground chunk covering an x position, clamped to the arena.
+ */
+static size_t chunk_at(level_t *level, double x) {
+  size_t i = first_vertex_at(level->file, x);
+  size_t chunk = i > 0 ? (i - 1) / GROUND_CHUNK_EDGES : 0;
+  return chunk < level->num_chunks ? chunk : level->num_chunks - 1;
 }
 
-double mesa_height(double x, double w) {
-  if (x < MESA_CLIFF_RATIO * w) {
-    return ARENA_HEIGHT + MESA_LOW_HEIGHT;
-  } else {
-    return ARENA_HEIGHT + MESA_TOP_HEIGHT;
-  }
-}
-
-double moon_height(double x, double w) {
-  double y =
-      ARENA_HEIGHT -
-      (MOON_CRATER_DEPTH * exp(-pow((x - 0.5 * w) / MOON_CRATER_HALFWIDTH, 2)));
-  return y + MOON_LIP_HEIGHT * exp(-pow((fabs(x - 0.5 * w) - MOON_LIP_OFFSET) /
-                                            MOON_LIP_HALFWIDTH,
-                                        2));
-}
-
-body_t *make_ground(level_info_t info) {
-  list_t *verts = list_init(NUM_ARENA_VERTICES + NUM_WALL_VERITCES, free);
-  double dx = info.screen_max.x / (double)(NUM_ARENA_VERTICES - 1);
-  double w = info.screen_max.x - info.screen_min.x;
-  double cliff_x = MESA_CLIFF_RATIO * w;
-  bool cliff_inserted = false;
-
-  for (size_t i = 0; i < NUM_ARENA_VERTICES; i++) {
-    double x = i * dx;
-    double y;
-    switch (info.type) {
-    case FOREST:
-      y = forest_height(x, w);
-      break;
-    case MESA:
-      if (!cliff_inserted && x >= cliff_x) {
-        vector_t *v_low = malloc(sizeof *v_low);
-        *v_low = (vector_t){cliff_x, ARENA_HEIGHT + MESA_LOW_HEIGHT};
-        list_add(verts, v_low);
-        vector_t *v_high = malloc(sizeof *v_high);
-        *v_high = (vector_t){cliff_x, ARENA_HEIGHT + MESA_TOP_HEIGHT};
-        list_add(verts, v_high);
-
-        cliff_inserted = true;
-      }
-      y = mesa_height(x, w);
-      break;
-    case MOON:
-      y = moon_height(x, w);
-      break;
-    default:
-      y = ARENA_HEIGHT;
-    }
+/**
+ * Builds the body for one ground chunk from the level file's surface,
+ * closed off along the bottom of the arena.
+ *
+ * @param level the level the chunk belongs to
+ * @param chunk the chunk to build
+ * @return the chunk's body
+ */
+static body_t *make_chunk_body(level_t *level, const ground_chunk_t *chunk) {
+  const vector_t *surface = level->file->ground_vertices + chunk->first;
+  double bottom = level->info.screen_min.y;
+  size_t n = chunk->count + NUM_WALL_VERITCES;
+  vector_t *verts = malloc(sizeof(vector_t) * n);
+  assert(verts);
+  memcpy(verts, surface, sizeof(vector_t) * chunk->count);
+  verts[n - 2] = (vector_t){surface[chunk->count - 1].x, bottom};
+  verts[n - 1] = (vector_t){surface[0].x, bottom};
+  vector_t centroid;
+  shape_t *shape = shape_init(verts, n, &centroid);
+  free(verts);
+  body_t *ground = body_init_with_shape(shape, centroid, IMMOVABLE_MASS,
+                                        level->info.terrain_color, NULL, NULL);
+  shape_release(shape);
+  body_set_kind(ground, BODY_GROUND);
+  body_set_collision_filter(ground, LAYER_TERRAIN, 0);
+  return ground;
+}
 
-    if (i == 0 || i == NUM_ARENA_VERTICES - 1) {
-      y = ARENA_HEIGHT;
-    }
-    vector_t *v = malloc(sizeof *v);
-    *v = (vector_t){x, y};
-    list_add(verts, v);
+/**
+ * Splits the ground's surface into chunks of GROUND_CHUNK_EDGES edges.
+ * Neighbouring chunks share their boundary vertex. No bodies are built.
+ */
+static void init_chunks(level_t *level) {
+  size_t n = level->file->header->num_ground_vertices;
+  assert(n >= 2);
+  level->num_chunks = (n - 2) / GROUND_CHUNK_EDGES + 1;
+  level->chunks = malloc(sizeof(ground_chunk_t) * level->num_chunks);
+  assert(level->chunks);
+  for (size_t c = 0; c < level->num_chunks; c++) {
+    size_t first = c * GROUND_CHUNK_EDGES;
+    size_t count = fmin(GROUND_CHUNK_EDGES + 1, n - first);
+    level->chunks[c] = (ground_chunk_t){.first = first, .count = count};
   }
-  vector_t *br = malloc(sizeof(vector_t));
-  vector_t *bl = malloc(sizeof(vector_t));
-  *br = (vector_t){info.screen_max.x, info.screen_min.y};
-  *bl = (vector_t){info.screen_min.x, info.screen_min.y};
-  list_add(verts, br);
-  list_add(verts, bl);
-  return body_init_with_info(verts, IMMOVABLE_MASS, info.terrain_color,
-                             (void *)GROUND_INFO, NULL);
+  level->live_first = 0;
+  level->live_end = 0;
 }
 
-level_t *level_init(level_info_t info) {
+level_t *level_init(const char *path) {
+  level_file_t *file = level_file_open(path);
+  if (!file) {
+    return NULL;
+  }
   level_t *level = malloc(sizeof(level_t));
+  assert(level);
+  level->file = file;
+  const level_file_header_t *header = level->file->header;
 
+  level_info_t info = {.background_path = header->background_path,
+                       .gravity = header->gravity,
+                       .max_wind = header->max_wind,
+                       .air_drag = header->air_drag,
+                       .terrain_color = header->terrain_color,
+                       .screen_min = header->screen_min,
+                       .screen_max = header->screen_max,
+                       .turn_len = header->turn_len};
   level->info = info;
   level->scene = scene_init();
-  level->gravity = info.gravity;
+  for (size_t p = 0; p < NUM_PARTITIONS; p++) {
+    level->partitions[p] = body_set_init();
+  }
+  for (size_t k = 0; k < NUM_BODY_KINDS; k++) {
+    level->spares[k] = body_set_init();
+  }
+  level->broad_phase = broad_phase_init();
+  level->contacts = contact_cache_init();
+  level->field = force_field_init(info.gravity, info.air_drag);
   level->max_wind = info.max_wind;
-  level->wind = VEC_ZERO;
-  SDL_Rect bg_rect = {info.screen_min.x, info.screen_min.y,
-                      info.screen_max.x - info.screen_min.x,
-                      info.screen_max.y - info.screen_min.y};
-  asset_make_image(info.background_path, bg_rect);
+  level->integrator = ARROW_INTEGRATOR;
+  level->max_step_travel = ARROW_MAX_STEP_TRAVEL;
+  init_chunks(level);
 
-  body_t *ground = make_ground(info);
-  scene_add_body(level->scene, ground);
+  level->ground = heightfield_wrap(header->sample_min_x, header->sample_dx,
+                                   header->num_samples, level->file->heights,
+                                   level->file->normals, header->max_height);
+  level->max_ground_height = header->max_height;
+  level->particles = particle_pool_init(PARTICLE_CAPACITY, PARTICLE_BUDGET);
 
   return level;
 }
 
-void level_tick(level_t *level, double dt) {
-  size_t n = scene_bodies(level->scene);
-  for (size_t i = 0; i < n; i++) {
-    body_t *b = scene_get_body(level->scene, i);
+void level_add_body(level_t *level, body_t *body) {
+  partition_t partition = PARTITION_DYNAMIC;
+  if (body_get_mass(body) == IMMOVABLE_MASS) {
+    vector_t v = body_get_velocity(body);
+    partition = v.x == 0 && v.y == 0 ? PARTITION_STATIC : PARTITION_KINEMATIC;
+  }
+  body_set_add(level->partitions[partition], body);
+  if (partition == PARTITION_STATIC) {
+    scene_add_body(level->scene, body);
+    broad_phase_set_static(level->broad_phase,
+                           level->partitions[PARTITION_STATIC]);
+  }
+}
+
+body_t *level_make_body(level_t *level, body_kind_t kind, shape_t *shape,
+                        vector_t centroid, double mass, color_t color) {
+  body_set_t *spares = level->spares[kind];
+  body_t *body;
+  if (spares->count > 0) {
+    spares->count--;
+    body = spares->bodies[spares->count];
+    body_recycle(body, shape, centroid, mass, color);
+  } else {
+    body = body_init_with_shape(shape, centroid, mass, color, NULL, NULL);
+  }
+  body_set_kind(body, kind);
+  return body;
+}
+
+/**
+ * Frees a body that has left the level, or keeps it for level_make_body()
+ * to reuse if there is room among the spares of its kind. Bodies with info
+ * are always freed, since their info may be owned elsewhere.
+ */
+static void release_body(level_t *level, body_t *body) {
+  body_set_t *spares = level->spares[body_get_kind(body)];
+  if (body_get_info(body) || spares->count >= MAX_SPARE_BODIES) {
+    body_free(body);
+  } else {
+    body_set_add(spares, body);
+  }
+}
+
+bool level_has_body(level_t *level, const body_t *body) {
+  for (size_t p = 0; p < NUM_PARTITIONS; p++) {
+    if (body_set_contains(level->partitions[p], body)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Checks a dynamic body against the arena and the ground before it is
+ * ticked: removes it if it has left the arena or is an arrow that hit the
+ * ground.
+ *
+ * @param level the level the body is in
+ * @param b the body to check
+ */
+static void update_dynamic_body(level_t *level, body_t *b) {
+  vector_t center = body_get_centroid(b);
+  if (center.x < level->info.screen_min.x ||
+      center.x > level->info.screen_max.x ||
+      center.y < level->info.screen_min.y) {
+    body_remove(b);
+  } else if (arrow_check_ground_collision(level, b)) {
+    arrow_spawn_impact_burst(level, center);
+    level_carve_crater(level, center.x, arrow_crater_radius(b));
+    body_remove(b);
+  } else if (body_get_kind(b) == BODY_ARROW) {
+    // gravity and wind come from the level's force field; only arrows'
+    // orientation needs updating
+    vector_t v = body_get_velocity(b);
+    body_set_rotation(b, atan2(v.y, v.x));
+  }
+}
+
+/**
+ * Ticks the bodies in a moving partition and releases those marked for
+ * removal.
+ *
+ * @param level the level the partition belongs to
+ * @param set the partition to tick
+ * @param dt the timestep to apply
+ * @return the number of bodies released
+ */
+static size_t tick_partition(level_t *level, body_set_t *set, double dt) {
+  size_t kept = 0;
+  for (size_t i = 0; i < set->count; i++) {
+    body_t *b = set->bodies[i];
     if (body_is_removed(b)) {
-      continue;
+      release_body(level, b);
+    } else {
+      body_tick(b, dt);
+      set->bodies[kept++] = b;
+    }
+  }
+  size_t freed = set->count - kept;
+  set->count = kept;
+  return freed;
+}
+
+/**
+ * Drops the static bodies marked for removal from the static partition and
+ * has the scene free them.
+ */
+static void sweep_static_bodies(level_t *level) {
+  body_set_t *statics = level->partitions[PARTITION_STATIC];
+  size_t kept = 0;
+  for (size_t i = 0; i < statics->count; i++) {
+    if (!body_is_removed(statics->bodies[i])) {
+      statics->bodies[kept++] = statics->bodies[i];
+    }
+  }
+  if (kept == statics->count) {
+    return;
+  }
+  statics->count = kept;
+  broad_phase_set_static(level->broad_phase, statics);
+  // the scene only holds static bodies, so ticking it moves nothing; it
+  // just frees the removed ones
+  scene_tick(level->scene, 0);
+}
+
+void level_tick(level_t *level, double dt) {
+  body_set_t *dynamic = level->partitions[PARTITION_DYNAMIC];
+  for (size_t i = 0; i < dynamic->count; i++) {
+    body_t *b = dynamic->bodies[i];
+    if (!body_is_removed(b)) {
+      update_dynamic_body(level, b);
     }
-    vector_t center = body_get_centroid(b);
-    if (body_get_mass(b) != IMMOVABLE_MASS &&
-        (center.x < level->info.screen_min.x ||
-         center.x > level->info.screen_max.x ||
-         center.y < level->info.screen_min.y)) {
-      body_remove(b);
-    } else if (arrow_check_ground_collision(level, b)) {
-      arrow_spawn_impact_burst(level, center, IMPACT_BURST_COUNT);
-      body_remove(b);
-    } else if (particle_check_ground_collision(level, b)) {
-      body_remove(b);
-    } else if (body_get_mass(b) != IMMOVABLE_MASS) {
-      double m = body_get_mass(b);
-      body_add_force(b, vec_multiply(m, level->gravity));
-      body_add_force(b, vec_multiply(m, level->wind));
-      vector_t v = body_get_velocity(b);
-      double angle = atan2(v.y, v.x);
-      body_set_rotation(b, angle);
+  }
+  // integrate each moving body once; the broad phase, the arrows' sweeps and
+  // tick_partition() all use the result
+  for (size_t p = PARTITION_KINEMATIC; p <= PARTITION_DYNAMIC; p++) {
+    body_set_t *set = level->partitions[p];
+    for (size_t i = 0; i < set->count; i++) {
+      if (!body_is_removed(set->bodies[i])) {
+        body_predict(set->bodies[i], dt);
+      }
     }
   }
-  scene_tick(level->scene, dt);
+
+  // the kinematic and dynamic partitions are next to each other
+  broad_phase_update(level->broad_phase,
+                     level->partitions + PARTITION_KINEMATIC,
+                     PARTITION_DYNAMIC - PARTITION_KINEMATIC + 1, dt);
+  arrow_tick_t arrow_tick = {.contacts = level->contacts};
+  broad_phase_query(level->broad_phase, arrow_handle_pair, &arrow_tick);
+  contact_cache_end_tick(level->contacts, NULL, NULL);
+  arrow_forget_removed();
+  size_t freed =
+      tick_partition(level, level->partitions[PARTITION_KINEMATIC], dt) +
+      tick_partition(level, dynamic, dt);
+  // static bodies are only ever destroyed by the arrows that hit them, and
+  // those arrows are removed along with them
+  if (freed > 0) {
+    sweep_static_bodies(level);
+  }
 }
 
 double level_ground_height(level_t *level, double x) {
-  double w = level->info.screen_max.x;
-  switch (level->info.type) {
-  case FOREST:
-    return forest_height(x, w);
-  case MESA:
-    return mesa_height(x, w);
-  case MOON:
-    return moon_height(x, w);
-  default:
-    return ARENA_HEIGHT;
+  return heightfield_height(level->ground, x);
+}
+
+void level_carve_crater(level_t *level, double x, double radius) {
+  vector_t center = {x, level_ground_height(level, x)};
+  // never dig through the bottom of the ground body
+  radius = fmin(radius, center.y - level->info.screen_min.y);
+  if (radius <= 0) {
+    return;
+  }
+  heightfield_carve(level->ground, center, radius);
+
+  // the mapped surface is private to this process, so lowering it in place
+  // keeps chunks streamed in later in step with the heightfield
+  vector_t *verts = level->file->ground_vertices;
+  size_t n = level->file->header->num_ground_vertices;
+  size_t first_changed = SIZE_MAX;
+  size_t last_changed = 0;
+  for (size_t i = first_vertex_at(level->file, x - radius);
+       i < n && verts[i].x <= x + radius; i++) {
+    double y = level_ground_height(level, verts[i].x);
+    if (y >= verts[i].y) {
+      continue;
+    }
+    verts[i].y = y;
+    if (first_changed == SIZE_MAX) {
+      first_changed = i;
+    }
+    last_changed = i;
+  }
+  if (first_changed == SIZE_MAX) {
+    return;
+  }
+
+  // bodies' shapes are immutable, so the streamed-in chunks the crater
+  // touches are rebuilt. A vertex on a chunk boundary is the last of one
+  // chunk and the first of the next, and the last chunk may be short, so
+  // each chunk's own range is checked rather than dividing by its length.
+  size_t c = first_changed / GROUND_CHUNK_EDGES;
+  c = c > 0 ? c - 1 : 0;
+  for (; c < level->num_chunks && level->chunks[c].first <= last_changed;
+       c++) {
+    ground_chunk_t *chunk = &level->chunks[c];
+    if (chunk->first + chunk->count > first_changed && chunk->body) {
+      body_free(chunk->body);
+      chunk->body = make_chunk_body(level, chunk);
+    }
+  }
+}
+
+void level_stream_ground(level_t *level, double min_x, double max_x) {
+  // chunks are sorted by x, so the ones overlapping the range are contiguous
+  size_t first = chunk_at(level, min_x);
+  size_t end = chunk_at(level, max_x) + 1;
+  for (size_t c = level->live_first; c < level->live_end; c++) {
+    ground_chunk_t *chunk = &level->chunks[c];
+    if ((c < first || c >= end) && chunk->body) {
+      body_free(chunk->body);
+      chunk->body = NULL;
+    }
   }
+  for (size_t c = first; c < end; c++) {
+    ground_chunk_t *chunk = &level->chunks[c];
+    if (!chunk->body) {
+      chunk->body = make_chunk_body(level, chunk);
+    }
+  }
+  level->live_first = first;
+  level->live_end = end;
 }
 
-const char *get_ground_info() { return GROUND_INFO; }
+void level_render_ground(level_t *level) {
+  SDL_Rect visible = get_visible_rect();
+  for (size_t c = level->live_first; c < level->live_end; c++) {
+    body_t *body = level->chunks[c].body;
+    SDL_Rect box = sdl_get_body_bounding_box(body);
+    if (SDL_HasIntersection(&box, &visible)) {
+      // the chunk's outline follows the terrain and need not be convex
+      const ground_chunk_t *chunk = &level->chunks[c];
+      sdl_draw_ground(level->file->ground_vertices + chunk->first,
+                      chunk->count, level->info.screen_min.y,
+                      level->info.terrain_color);
+    }
+  }
+}
+
+void level_render_bodies(level_t *level) {
+  for (size_t p = PARTITION_KINEMATIC; p < NUM_PARTITIONS; p++) {
+    body_set_t *set = level->partitions[p];
+    sdl_render_bodies(set->bodies, set->count);
+  }
+}
+
+vector_t level_ground_normal(level_t *level, double x) {
+  return heightfield_normal(level->ground, x);
+}
+
+void level_predict_flight(level_t *level, vector_t *pos, vector_t *vel,
+                          double dt) {
+  integrator_advance(level->integrator, pos, vel, dt, level->max_step_travel,
+                     force_field_accel, level->field);
+}
 
 void level_destroy(level_t *level) {
   if (!level) {
     return;
   }
+  arrow_forget_all();
+  for (size_t p = 0; p < NUM_PARTITIONS; p++) {
+    body_set_t *set = level->partitions[p];
+    // the scene frees the static bodies
+    for (size_t i = 0; p != PARTITION_STATIC && i < set->count; i++) {
+      body_free(set->bodies[i]);
+    }
+    body_set_free(set);
+  }
+  for (size_t k = 0; k < NUM_BODY_KINDS; k++) {
+    body_set_t *spares = level->spares[k];
+    for (size_t i = 0; i < spares->count; i++) {
+      body_free(spares->bodies[i]);
+    }
+    body_set_free(spares);
+  }
+  broad_phase_free(level->broad_phase);
+  contact_cache_free(level->contacts);
+  force_field_free(level->field);
+  for (size_t c = level->live_first; c < level->live_end; c++) {
+    if (level->chunks[c].body) {
+      body_free(level->chunks[c].body);
+    }
+  }
+  free(level->chunks);
+  heightfield_free(level->ground);
+  particle_pool_free(level->particles);
+  level_file_close(level->file);
   scene_free(level->scene);
   free(level);
 }
@@ -0,0 +1,142 @@
+#include "level_file.h"
+#include "heightfield.h"
+#include "vector.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(level_file_header_t) % 8 == 0,
+               "arrays following the header must stay 8-byte aligned");
+
+/**
+ * Checks that an array described by the header lies entirely inside the file
+ * and is suitably aligned to be read in place.
+ *
+ * @param file_size the size of the file in bytes
+ * @param offset the array's byte offset
+ * @param count the number of elements in the array
+ * @param elem_size the size of one element
+ * @return whether the array can be read from the mapping
+ */
+static bool array_fits(size_t file_size, uint64_t offset, uint64_t count,
+                       size_t elem_size) {
+  return offset % 8 == 0 && offset <= file_size &&
+         count <= (file_size - offset) / elem_size;
+}
+
+/**
+ * Checks the parts of a header the loader relies on.
+ */
+static bool header_is_valid(const level_file_header_t *h, size_t size) {
+  return h->magic == LEVEL_FILE_MAGIC && h->version == LEVEL_FILE_VERSION &&
+         h->background_path[LEVEL_FILE_PATH_LEN - 1] == '\0' &&
+         h->num_samples >= 2 && h->sample_dx > 0 &&
+         h->num_ground_vertices >= 2 && h->num_spawns >= 2 &&
+         array_fits(size, h->heights_offset, h->num_samples, sizeof(double)) &&
+         array_fits(size, h->normals_offset, h->num_samples,
+                    sizeof(vector_t)) &&
+         array_fits(size, h->ground_vertices_offset, h->num_ground_vertices,
+                    sizeof(vector_t)) &&
+         array_fits(size, h->spawns_offset, h->num_spawns, sizeof(vector_t)) &&
+         array_fits(size, h->crate_zones_offset, h->num_crate_zones,
+                    sizeof(level_zone_t));
+}
+
+level_file_t *level_file_open(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      (size_t)st.st_size < sizeof(level_file_header_t)) {
+    close(fd);
+    return NULL;
+  }
+  size_t size = (size_t)st.st_size;
+  // private and writable so carving the terrain copies only the touched pages
+  void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return NULL;
+  }
+
+  const level_file_header_t *header = data;
+  if (!header_is_valid(header, size)) {
+    munmap(data, size);
+    return NULL;
+  }
+
+  level_file_t *file = malloc(sizeof(level_file_t));
+  assert(file);
+  char *bytes = data;
+  file->data = data;
+  file->size = size;
+  file->header = header;
+  file->heights = (double *)(bytes + header->heights_offset);
+  file->normals = (vector_t *)(bytes + header->normals_offset);
+  file->ground_vertices =
+      (vector_t *)(bytes + header->ground_vertices_offset);
+  file->spawns = (const vector_t *)(bytes + header->spawns_offset);
+  file->crate_zones =
+      (const level_zone_t *)(bytes + header->crate_zones_offset);
+  return file;
+}
+
+void level_file_close(level_file_t *file) {
+  munmap(file->data, file->size);
+  free(file);
+}
+
+bool level_file_write(const char *path, level_file_header_t header,
+                      const heightfield_t *ground,
+                      const vector_t *ground_vertices,
+                      size_t num_ground_vertices, const vector_t *spawns,
+                      size_t num_spawns, const level_zone_t *crate_zones,
+                      size_t num_crate_zones) {
+  size_t num_samples;
+  const double *heights;
+  const vector_t *normals;
+  heightfield_get_samples(ground, &header.sample_min_x, &header.sample_dx,
+                          &num_samples, &heights, &normals);
+
+  header.magic = LEVEL_FILE_MAGIC;
+  header.version = LEVEL_FILE_VERSION;
+  header.max_height = heightfield_max_height(ground);
+  header.num_samples = num_samples;
+  header.num_ground_vertices = num_ground_vertices;
+  header.num_spawns = num_spawns;
+  header.num_crate_zones = num_crate_zones;
+
+  // every element size is a multiple of 8, so the arrays stay aligned
+  uint64_t offset = sizeof(level_file_header_t);
+  header.heights_offset = offset;
+  offset += num_samples * sizeof(double);
+  header.normals_offset = offset;
+  offset += num_samples * sizeof(vector_t);
+  header.ground_vertices_offset = offset;
+  offset += num_ground_vertices * sizeof(vector_t);
+  header.spawns_offset = offset;
+  offset += num_spawns * sizeof(vector_t);
+  header.crate_zones_offset = offset;
+
+  FILE *out = fopen(path, "wb");
+  if (!out) {
+    return false;
+  }
+  bool ok =
+      fwrite(&header, sizeof(header), 1, out) == 1 &&
+      fwrite(heights, sizeof(double), num_samples, out) == num_samples &&
+      fwrite(normals, sizeof(vector_t), num_samples, out) == num_samples &&
+      fwrite(ground_vertices, sizeof(vector_t), num_ground_vertices, out) ==
+          num_ground_vertices &&
+      fwrite(spawns, sizeof(vector_t), num_spawns, out) == num_spawns &&
+      fwrite(crate_zones, sizeof(level_zone_t), num_crate_zones, out) ==
+          num_crate_zones;
+  return fclose(out) == 0 && ok;
+}
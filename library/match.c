@@ -0,0 +1,72 @@
+#include "match.h"
+#include "level.h"
+#include "player.h"
+#include "shoot.h"
+#include "turn_engine.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * Fires player one's next scripted shot.
+ */
+static void fire_scripted_shot(turn_engine_t *eng,
+                               const scripted_shot_t *shot) {
+  body_t *shooter =
+      scene_get_body(eng->level->scene, eng->p_body_idx[PLAYER_ONE]);
+  vector_t vel = {shot->speed * cos(shot->angle),
+                  shot->speed * sin(shot->angle)};
+  eng->equipped_arrow = shot->arrow;
+  shoot_fire(eng, shooter, vel);
+}
+
+match_result_t match_run(const match_config_t *config) {
+  srand(config->seed);
+  level_t *level = level_init(config->level_path);
+  assert(level);
+  const level_file_t *file = level->file;
+  assert(file->header->num_spawns >= 2);
+
+  body_t *p1 = player_init(PLAYER_ONE, file->spawns[0]);
+  body_t *p2 = player_init(PLAYER_TWO, file->spawns[1]);
+  size_t p1_idx = scene_bodies(level->scene);
+  level_add_body(level, p1);
+  level_add_body(level, p2);
+  turn_engine_t *eng =
+      turn_engine_init(level, NULL, level->info.turn_len, p1_idx, p1_idx + 1);
+
+  match_result_t result = {.outcome = MATCH_DRAW};
+  size_t max_steps = config->max_time / config->dt;
+  size_t next_shot = 0;
+  bool fired = false;
+  player_id_t active = eng->active;
+  while (result.steps < max_steps) {
+    if (eng->active == PLAYER_ONE && !fired &&
+        next_shot < config->num_shots) {
+      fire_scripted_shot(eng, &config->shots[next_shot++]);
+      fired = true;
+    }
+    level_tick(level, config->dt);
+    turn_engine_update(eng, config->dt);
+    result.steps++;
+    if (eng->active != active) {
+      active = eng->active;
+      fired = false;
+      result.turns++;
+    }
+
+    int32_t hp1 = eng_get_player_hp(eng, PLAYER_ONE);
+    int32_t hp2 = eng_get_player_hp(eng, PLAYER_TWO);
+    if (hp1 <= 0 || hp2 <= 0) {
+      // same tie-break as the game-over screen
+      result.outcome = (hp2 <= 0 && hp1 > 0) ? MATCH_P1_WINS : MATCH_P2_WINS;
+      break;
+    }
+  }
+  result.hp[PLAYER_ONE] = eng_get_player_hp(eng, PLAYER_ONE);
+  result.hp[PLAYER_TWO] = eng_get_player_hp(eng, PLAYER_TWO);
+  turn_engine_destroy(eng);
+  return result;
+}
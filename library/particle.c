@@ -0,0 +1,187 @@
+#include "particle.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// any nonzero value will do
+const uint64_t PARTICLE_RANDOM_SEED = 0x9e3779b97f4a7c15;
+
+/**
+ * Reallocates one of a pool's attribute arrays at a new capacity, moving the
+ * pool's particles to the front of it, oldest first.
+ *
+ * @param array the array to reallocate; freed and replaced
+ * @param elem_size the size of one element
+ * @param pool the pool, still describing the old array
+ * @param capacity the new capacity
+ */
+static void regrow_array(void **array, size_t elem_size,
+                         const particle_pool_t *pool, size_t capacity) {
+  char *old = *array;
+  char *grown = malloc(capacity * elem_size);
+  assert(grown);
+  if (old) {
+    size_t first = fmin(pool->count, pool->capacity - pool->head);
+    memcpy(grown, old + pool->head * elem_size, first * elem_size);
+    memcpy(grown + first * elem_size, old, (pool->count - first) * elem_size);
+    free(old);
+  }
+  *array = grown;
+}
+
+/**
+ * Moves a pool's particles into arrays of a new capacity.
+ */
+static void regrow(particle_pool_t *pool, size_t capacity) {
+  regrow_array((void **)&pool->x, sizeof(float), pool, capacity);
+  regrow_array((void **)&pool->y, sizeof(float), pool, capacity);
+  regrow_array((void **)&pool->vx, sizeof(float), pool, capacity);
+  regrow_array((void **)&pool->vy, sizeof(float), pool, capacity);
+  regrow_array((void **)&pool->lifetime, sizeof(float), pool, capacity);
+  regrow_array((void **)&pool->max_lifetime, sizeof(float), pool, capacity);
+  regrow_array((void **)&pool->size, sizeof(float), pool, capacity);
+  regrow_array((void **)&pool->weight, sizeof(float), pool, capacity);
+  regrow_array((void **)&pool->rgba, sizeof(uint32_t), pool, capacity);
+  pool->head = 0;
+  pool->capacity = capacity;
+}
+
+particle_pool_t *particle_pool_init(size_t capacity, size_t budget) {
+  assert(capacity > 0 && capacity <= budget);
+  particle_pool_t *pool = calloc(1, sizeof(particle_pool_t));
+  assert(pool);
+  pool->budget = budget;
+  pool->random_state = PARTICLE_RANDOM_SEED;
+  regrow(pool, capacity);
+  return pool;
+}
+
+void particle_pool_emit(particle_pool_t *pool, vector_t pos, vector_t vel,
+                        double lifetime, double size, double weight,
+                        color_t color) {
+  assert(lifetime > 0);
+  if (pool->count == pool->capacity) {
+    if (pool->capacity < pool->budget) {
+      regrow(pool, fmin(pool->capacity * 2, pool->budget));
+    } else {
+      pool->head = (pool->head + 1) % pool->capacity;
+      pool->count--;
+    }
+  }
+  size_t i = particle_pool_slot(pool, pool->count);
+  pool->x[i] = pos.x;
+  pool->y[i] = pos.y;
+  pool->vx[i] = vel.x;
+  pool->vy[i] = vel.y;
+  pool->lifetime[i] = lifetime;
+  pool->max_lifetime[i] = lifetime;
+  pool->size[i] = size;
+  pool->weight[i] = weight;
+  pool->rgba[i] = particle_pack_color(color);
+  pool->count++;
+}
+
+size_t particle_pool_slot(const particle_pool_t *pool, size_t i) {
+  size_t slot = pool->head + i;
+  return slot < pool->capacity ? slot : slot - pool->capacity;
+}
+
+double particle_pool_random(particle_pool_t *pool, double min, double max) {
+  // xorshift64*; the top 53 bits make a uniform double in [0, 1)
+  uint64_t s = pool->random_state;
+  s ^= s >> 12;
+  s ^= s << 25;
+  s ^= s >> 27;
+  pool->random_state = s;
+  double unit = ((s * 0x2545f4914f6cdd1d) >> 11) * 0x1.0p-53;
+  return min + (max - min) * unit;
+}
+
+/**
+ * Advances the particles in a contiguous run of slots by one timestep.
+ *
+ * @param pool the pool
+ * @param first the first slot of the run
+ * @param end one past the last slot of the run
+ * @param dt the timestep
+ * @param accel the acceleration applied to particles of weight 1
+ * @param ground the terrain particles come to rest on
+ */
+static void update_slots(particle_pool_t *pool, size_t first, size_t end,
+                         float dt, vector_t accel,
+                         const heightfield_t *ground) {
+  float *restrict x = pool->x;
+  float *restrict y = pool->y;
+  float *restrict vx = pool->vx;
+  float *restrict vy = pool->vy;
+  float *restrict lifetime = pool->lifetime;
+  const float *restrict weight = pool->weight;
+  float dvx = accel.x * dt;
+  float dvy = accel.y * dt;
+
+  // every particle gets the same arithmetic and nothing branches, so this
+  // loop vectorizes
+  for (size_t i = first; i < end; i++) {
+    vx[i] += weight[i] * dvx;
+    vy[i] += weight[i] * dvy;
+    x[i] += vx[i] * dt;
+    y[i] += vy[i] * dt;
+    lifetime[i] -= dt;
+  }
+
+  // the terrain lookup is a gather, so it gets its own loop
+  for (size_t i = first; i < end; i++) {
+    if (weight[i] == 0) {
+      continue;
+    }
+    float height = heightfield_height(ground, x[i]);
+    if (y[i] < height) {
+      y[i] = height;
+      vx[i] = 0;
+      vy[i] = 0;
+    }
+  }
+}
+
+void particle_pool_update(particle_pool_t *pool, double dt, vector_t accel,
+                          const heightfield_t *ground) {
+  size_t first = fmin(pool->count, pool->capacity - pool->head);
+  update_slots(pool, pool->head, pool->head + first, dt, accel, ground);
+  update_slots(pool, 0, pool->count - first, dt, accel, ground);
+  while (pool->count > 0 && pool->lifetime[pool->head] <= 0) {
+    pool->head = particle_pool_slot(pool, 1);
+    pool->count--;
+  }
+}
+
+void particle_pool_clear(particle_pool_t *pool) {
+  pool->head = 0;
+  pool->count = 0;
+}
+
+void particle_pool_free(particle_pool_t *pool) {
+  free(pool->x);
+  free(pool->y);
+  free(pool->vx);
+  free(pool->vy);
+  free(pool->lifetime);
+  free(pool->max_lifetime);
+  free(pool->size);
+  free(pool->weight);
+  free(pool->rgba);
+  free(pool);
+}
+
+/**
+ * Converts a color channel between 0 and 1 to a byte.
+ */
+static uint32_t channel_byte(double channel) {
+  return (uint32_t)lround(fmin(fmax(channel, 0), 1) * 255);
+}
+
+uint32_t particle_pack_color(color_t color) {
+  return channel_byte(color.red) << 24 | channel_byte(color.green) << 16 |
+         channel_byte(color.blue) << 8 | 0xff;
+}
@@ -0,0 +1,39 @@
+#include "player.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const color_t PLAYER_COLORS[] = {{.blue = 1, .green = 0, .red = 0},
+                                 {.blue = 0, .green = 0, .red = 1}};
+const double PLAYER_HALF_PX = 32;
+const vector_t PLAYER_HITBOX[4] = {{-PLAYER_HALF_PX, -PLAYER_HALF_PX},
+                                   {PLAYER_HALF_PX, -PLAYER_HALF_PX},
+                                   {PLAYER_HALF_PX, PLAYER_HALF_PX},
+                                   {-PLAYER_HALF_PX, PLAYER_HALF_PX}};
+const size_t PLAYER_HITBOX_PTS = 4;
+const double PLAYER_MASS = INFINITY;
+const int32_t PLAYER_HP = 100;
+
+/**
+ * The hitbox shared by both players, built on first use and kept for the
+ * life of the program.
+ */
+static shape_t *PLAYER_SHAPE = NULL;
+
+body_t *player_init(player_id_t id, vector_t spawn) {
+  vector_t pos = {spawn.x, spawn.y + PLAYER_HALF_PX};
+  if (!PLAYER_SHAPE) {
+    PLAYER_SHAPE = shape_init(PLAYER_HITBOX, PLAYER_HITBOX_PTS, NULL);
+  }
+  int32_t *hp = malloc(sizeof(int32_t));
+  assert(hp);
+  *hp = PLAYER_HP;
+  body_t *body = body_init_with_shape(PLAYER_SHAPE, pos, PLAYER_MASS,
+                                      player_color(id), hp, free);
+  body_set_kind(body, BODY_PLAYER);
+  body_set_collision_filter(body, LAYER_TARGET, LAYER_PROJECTILE);
+  return body;
+}
+
+color_t player_color(player_id_t id) { return PLAYER_COLORS[id]; }
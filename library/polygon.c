@@ -0,0 +1,127 @@
+#include "polygon.h"
+#include "vector.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Gets a polygon's coordinate arrays for writing, laid out as in polygon_t.
+ */
+static double *coords_of(polygon_t *polygon) {
+  return polygon->heap ? polygon->heap : polygon->inline_coords;
+}
+
+/**
+ * Makes room in a polygon for n vertices and sets its vertex count. The
+ * contents are left unspecified.
+ */
+static void resize(polygon_t *polygon, size_t n) {
+  if (n > polygon->capacity) {
+    free(polygon->heap);
+    polygon->heap = malloc(sizeof(double) * 4 * n);
+    assert(polygon->heap);
+    polygon->capacity = n;
+  }
+  polygon->num_vertices = n;
+}
+
+void polygon_init(polygon_t *polygon) {
+  polygon->num_vertices = 0;
+  polygon->capacity = POLYGON_INLINE_CAPACITY;
+  polygon->heap = NULL;
+}
+
+void polygon_set(polygon_t *polygon, const vector_t *vertices, size_t n) {
+  resize(polygon, n);
+  double *xs = coords_of(polygon);
+  double *ys = xs + polygon->capacity;
+  double *nxs = ys + polygon->capacity;
+  double *nys = nxs + polygon->capacity;
+  for (size_t i = 0; i < n; i++) {
+    xs[i] = vertices[i].x;
+    ys[i] = vertices[i].y;
+  }
+  for (size_t i = 0; i < n; i++) {
+    vector_t edge = vec_subtract(vertices[(i + 1) % n], vertices[i]);
+    double length = vec_get_length(edge);
+    nxs[i] = length == 0 ? 0 : edge.y / length;
+    nys[i] = length == 0 ? 0 : -edge.x / length;
+  }
+}
+
+void polygon_transform(polygon_t *polygon, const polygon_t *source,
+                       vector_t translation, double cos_angle,
+                       double sin_angle) {
+  assert(polygon != source);
+  size_t n = source->num_vertices;
+  resize(polygon, n);
+  double *xs = coords_of(polygon);
+  double *ys = xs + polygon->capacity;
+  double *nxs = ys + polygon->capacity;
+  double *nys = nxs + polygon->capacity;
+  memcpy(xs, polygon_xs(source), sizeof(double) * n);
+  memcpy(ys, polygon_ys(source), sizeof(double) * n);
+  memcpy(nxs, polygon_normal_xs(source), sizeof(double) * n);
+  memcpy(nys, polygon_normal_ys(source), sizeof(double) * n);
+  vec_batch_rotate(xs, ys, n, cos_angle, sin_angle);
+  vec_batch_translate(xs, ys, n, translation);
+  vec_batch_rotate(nxs, nys, n, cos_angle, sin_angle);
+}
+
+const double *polygon_xs(const polygon_t *polygon) {
+  return polygon->heap ? polygon->heap : polygon->inline_coords;
+}
+
+const double *polygon_ys(const polygon_t *polygon) {
+  return polygon_xs(polygon) + polygon->capacity;
+}
+
+const double *polygon_normal_xs(const polygon_t *polygon) {
+  return polygon_xs(polygon) + 2 * polygon->capacity;
+}
+
+const double *polygon_normal_ys(const polygon_t *polygon) {
+  return polygon_xs(polygon) + 3 * polygon->capacity;
+}
+
+vector_t polygon_vertex(const polygon_t *polygon, size_t i) {
+  return (vector_t){polygon_xs(polygon)[i], polygon_ys(polygon)[i]};
+}
+
+vector_t polygon_normal(const polygon_t *polygon, size_t i) {
+  return (vector_t){polygon_normal_xs(polygon)[i],
+                    polygon_normal_ys(polygon)[i]};
+}
+
+double polygon_signed_area(const polygon_t *polygon) {
+  size_t n = polygon->num_vertices;
+  double sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    sum += vec_cross(polygon_vertex(polygon, i),
+                     polygon_vertex(polygon, (i + 1) % n));
+  }
+  return sum / 2;
+}
+
+vector_t polygon_centroid(const polygon_t *polygon) {
+  size_t n = polygon->num_vertices;
+  double area = polygon_signed_area(polygon);
+  vector_t sum = VEC_ZERO;
+  for (size_t i = 0; i < n; i++) {
+    vector_t a = polygon_vertex(polygon, i);
+    vector_t b = polygon_vertex(polygon, (i + 1) % n);
+    double cross = vec_cross(a, b);
+    sum.x += (a.x + b.x) * cross;
+    sum.y += (a.y + b.y) * cross;
+  }
+  return vec_multiply(1 / (6 * area), sum);
+}
+
+void polygon_free(polygon_t *polygon) {
+  free(polygon->heap);
+  polygon->heap = NULL;
+  polygon->capacity = POLYGON_INLINE_CAPACITY;
+  polygon->num_vertices = 0;
+}
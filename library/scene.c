@@ -0,0 +1,116 @@
+#include "scene.h"
+#include "body.h"
+#include "list.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+const size_t SCENE_INIT_CAPACITY = 16;
+
+/**
+ * A force creator registered with scene_add_force_creator().
+ */
+typedef struct {
+  force_creator_t creator;
+  void *aux;
+  // the bodies it acts on; not owned
+  list_t *bodies;
+  free_func_t freer;
+} force_record_t;
+
+typedef struct scene {
+  // owned by the scene
+  list_t *bodies;
+  list_t *forces;
+} scene_t;
+
+/**
+ * Frees a force record along with its aux value and body list.
+ */
+static void force_record_free(force_record_t *record) {
+  if (record->freer) {
+    record->freer(record->aux);
+  }
+  list_free(record->bodies);
+  free(record);
+}
+
+/**
+ * Checks whether any of the bodies a force creator acts on is marked for
+ * removal.
+ */
+static bool acts_on_removed(force_record_t *record) {
+  for (size_t i = 0; i < list_size(record->bodies); i++) {
+    if (body_is_removed(list_get(record->bodies, i))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+scene_t *scene_init(void) {
+  scene_t *scene = malloc(sizeof(scene_t));
+  assert(scene);
+  scene->bodies = list_init(SCENE_INIT_CAPACITY, (free_func_t)body_free);
+  scene->forces =
+      list_init(SCENE_INIT_CAPACITY, (free_func_t)force_record_free);
+  return scene;
+}
+
+size_t scene_bodies(scene_t *scene) { return list_size(scene->bodies); }
+
+body_t *scene_get_body(scene_t *scene, size_t index) {
+  return list_get(scene->bodies, index);
+}
+
+void scene_add_body(scene_t *scene, body_t *body) {
+  list_add(scene->bodies, body);
+}
+
+void scene_remove_body(scene_t *scene, size_t index) {
+  body_remove(scene_get_body(scene, index));
+}
+
+void scene_add_force_creator(scene_t *scene, force_creator_t force_creator,
+                             void *aux, list_t *bodies, free_func_t freer) {
+  force_record_t *record = malloc(sizeof(force_record_t));
+  assert(record);
+  *record = (force_record_t){.creator = force_creator,
+                             .aux = aux,
+                             .bodies = bodies,
+                             .freer = freer};
+  list_add(scene->forces, record);
+}
+
+void scene_tick(scene_t *scene, double dt) {
+  for (size_t i = 0; i < list_size(scene->forces); i++) {
+    force_record_t *record = list_get(scene->forces, i);
+    record->creator(record->aux, record->bodies);
+  }
+
+  // drop the force creators first, since they may still point at bodies
+  // about to be freed
+  for (size_t i = 0; i < list_size(scene->forces);) {
+    force_record_t *record = list_get(scene->forces, i);
+    if (acts_on_removed(record)) {
+      force_record_free(list_remove(scene->forces, i));
+    } else {
+      i++;
+    }
+  }
+  for (size_t i = 0; i < list_size(scene->bodies);) {
+    body_t *body = list_get(scene->bodies, i);
+    if (body_is_removed(body)) {
+      body_free(list_remove(scene->bodies, i));
+    } else {
+      body_tick(body, dt);
+      i++;
+    }
+  }
+}
+
+void scene_free(scene_t *scene) {
+  list_free(scene->forces);
+  list_free(scene->bodies);
+  free(scene);
+}
@@ -1,23 +1,44 @@
 #include "sdl_wrapper.h"
 #include "asset_cache.h"
+#include "polygon.h"
 #include "shoot.h"
 #include "state.h"
 #include <SDL2/SDL.h>
-#include <SDL2/SDL2_gfxPrimitives.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
-#include <time.h>
 
 const char WINDOW_TITLE[] = "CS 3";
 const size_t WINDOW_WIDTH = 1000;
 const size_t WINDOW_HEIGHT = 500;
 const SDL_Color SDL_BLACK = {0, 0, 0};
 const double MS_PER_S = 1000.0;
-const char *GND_INFO = "ground";
-const char *ARR_INFO = "arrow";
+const size_t BATCH_INIT_CAPACITY = 256;
+// batched circles get about this many sides per pixel of radius, within
+// these bounds
+const double CIRCLE_SIDES_PER_PX = 4;
+const size_t MIN_CIRCLE_SIDES = 8;
+const size_t MAX_CIRCLE_SIDES = 64;
+
+/**
+ * The batches primitives are collected in, one per blend mode.
+ */
+typedef enum { BATCH_OPAQUE, BATCH_BLENDED, NUM_BATCHES } batch_kind_t;
+
+const SDL_BlendMode BATCH_BLEND_MODES[NUM_BATCHES] = {
+    [BATCH_OPAQUE] = SDL_BLENDMODE_NONE, [BATCH_BLENDED] = SDL_BLENDMODE_BLEND};
+
+typedef struct {
+  SDL_Vertex *vertices;
+  size_t num_vertices;
+  size_t vertex_capacity;
+  // three per triangle, indexing into vertices
+  int *indices;
+  size_t num_indices;
+  size_t index_capacity;
+} primitive_batch_t;
 
 /**
  * The coordinate at the center of the screen.
@@ -46,24 +67,154 @@ key_handler_t key_handler = NULL;
  */
 uint32_t key_start_timestamp;
 /**
- * The value of clock() when time_since_last_tick() was last called.
- * Initially 0.
+ * The value of SDL's performance counter when time_since_last_tick() was last
+ * called. Initially 0.
+ */
+uint64_t last_counter = 0;
+/**
+ * How far between the last two simulation steps bodies are drawn.
+ * See sdl_set_interpolation().
  */
-clock_t last_clock = 0;
+double render_alpha = 1.0;
 
 mouse_handler_t mouse_handler = NULL;
 
-// NOTE: SDL_RenderDrawPoint expects an integer, not size_t and otherwise breaks
-void draw_dot(int x, int y, int r, SDL_Color color) {
-  SDL_Renderer *ren = sdl_get_renderer();
-  SDL_SetRenderDrawColor(ren, color.r, color.g, color.b, color.a);
-  for (int dx = -r; dx <= r; dx++) {
-    for (int dy = -r; dy <= r; dy++) {
-      if (dx * dx + dy * dy <= r * r) {
-        SDL_RenderDrawPoint(ren, (int)x + dx, (int)y + dy);
-      }
+/**
+ * The primitives added since the last sdl_batch_flush(). The arrays are kept
+ * between frames, so batching stops allocating once they fit a frame.
+ */
+static primitive_batch_t batches[NUM_BATCHES];
+
+/**
+ * Makes room in the batch for a primitive's color and returns the batch.
+ *
+ * @param color the primitive's color
+ * @param num_vertices the number of vertices the primitive adds
+ * @param num_indices the number of indices the primitive adds
+ * @return the batch the primitive belongs in
+ */
+static primitive_batch_t *reserve_batch(SDL_Color color, size_t num_vertices,
+                                        size_t num_indices) {
+  primitive_batch_t *batch =
+      &batches[color.a == 255 ? BATCH_OPAQUE : BATCH_BLENDED];
+  if (batch->num_vertices + num_vertices > batch->vertex_capacity) {
+    size_t capacity = batch->vertex_capacity ? batch->vertex_capacity
+                                             : BATCH_INIT_CAPACITY;
+    while (batch->num_vertices + num_vertices > capacity) {
+      capacity *= 2;
+    }
+    batch->vertices =
+        realloc(batch->vertices, sizeof(SDL_Vertex) * capacity);
+    assert(batch->vertices);
+    batch->vertex_capacity = capacity;
+  }
+  if (batch->num_indices + num_indices > batch->index_capacity) {
+    size_t capacity = batch->index_capacity ? batch->index_capacity
+                                            : BATCH_INIT_CAPACITY;
+    while (batch->num_indices + num_indices > capacity) {
+      capacity *= 2;
+    }
+    batch->indices = realloc(batch->indices, sizeof(int) * capacity);
+    assert(batch->indices);
+    batch->index_capacity = capacity;
+  }
+  return batch;
+}
+
+/**
+ * Adds a vertex to a batch that has room for it.
+ */
+static void push_vertex(primitive_batch_t *batch, double x, double y,
+                        SDL_Color color) {
+  batch->vertices[batch->num_vertices++] =
+      (SDL_Vertex){.position = {x, y}, .color = color};
+}
+
+/**
+ * Adds a triangle of vertices already in a batch that has room for it,
+ * given as offsets from the batch's vertex `base`.
+ */
+static void push_triangle(primitive_batch_t *batch, size_t base, size_t a,
+                          size_t b, size_t c) {
+  batch->indices[batch->num_indices++] = base + a;
+  batch->indices[batch->num_indices++] = base + b;
+  batch->indices[batch->num_indices++] = base + c;
+}
+
+/**
+ * Adds a filled quadrilateral to the batch, given its corners in order
+ * around it.
+ */
+static void batch_quad(const SDL_FPoint corners[4], SDL_Color color) {
+  primitive_batch_t *batch = reserve_batch(color, 4, 6);
+  size_t base = batch->num_vertices;
+  for (size_t i = 0; i < 4; i++) {
+    push_vertex(batch, corners[i].x, corners[i].y, color);
+  }
+  push_triangle(batch, base, 0, 1, 2);
+  push_triangle(batch, base, 0, 2, 3);
+}
+
+void sdl_batch_point(double x, double y, SDL_Color color) {
+  sdl_batch_rect(x, y, 1, 1, color);
+}
+
+void sdl_batch_rect(double x, double y, double w, double h, SDL_Color color) {
+  SDL_FPoint corners[4] = {{x, y}, {x + w, y}, {x + w, y + h}, {x, y + h}};
+  batch_quad(corners, color);
+}
+
+void sdl_batch_line(double x1, double y1, double x2, double y2,
+                    SDL_Color color) {
+  double length = hypot(x2 - x1, y2 - y1);
+  if (length == 0) {
+    sdl_batch_point(x1, y1, color);
+    return;
+  }
+  // half a pixel to either side of the line
+  double nx = -(y2 - y1) / length * 0.5;
+  double ny = (x2 - x1) / length * 0.5;
+  SDL_FPoint corners[4] = {{x1 + nx, y1 + ny},
+                           {x2 + nx, y2 + ny},
+                           {x2 - nx, y2 - ny},
+                           {x1 - nx, y1 - ny}};
+  batch_quad(corners, color);
+}
+
+void sdl_batch_circle(double x, double y, double r, SDL_Color color) {
+  size_t sides = fmax(MIN_CIRCLE_SIDES,
+                      fmin(MAX_CIRCLE_SIDES, ceil(CIRCLE_SIDES_PER_PX * r)));
+  primitive_batch_t *batch = reserve_batch(color, sides + 1, 3 * sides);
+  size_t base = batch->num_vertices;
+  push_vertex(batch, x, y, color);
+  for (size_t i = 0; i < sides; i++) {
+    double theta = 2 * M_PI * i / sides;
+    push_vertex(batch, x + r * cos(theta), y + r * sin(theta), color);
+    push_triangle(batch, base, 0, 1 + i, 1 + (i + 1) % sides);
+  }
+}
+
+void sdl_batch_flush(void) {
+  // leave the draw blend mode as the caller set it
+  SDL_BlendMode saved;
+  SDL_GetRenderDrawBlendMode(renderer, &saved);
+  for (size_t k = 0; k < NUM_BATCHES; k++) {
+    primitive_batch_t *batch = &batches[k];
+    if (batch->num_indices == 0) {
+      continue;
     }
+    SDL_SetRenderDrawBlendMode(renderer, BATCH_BLEND_MODES[k]);
+    SDL_RenderGeometry(renderer, NULL, batch->vertices, batch->num_vertices,
+                       batch->indices, batch->num_indices);
+    batch->num_vertices = 0;
+    batch->num_indices = 0;
   }
+  SDL_SetRenderDrawBlendMode(renderer, saved);
+}
+
+void draw_dot(int x, int y, int r, SDL_Color color) {
+  // half a pixel wider, to cover the pixels a pixel-by-pixel disc would
+  sdl_batch_circle(x, y, r + 0.5, color);
 }
 
 vector_t get_window_center(void) {
@@ -196,40 +347,69 @@ void sdl_clear(void) {
   SDL_RenderClear(renderer);
 }
 
+/**
+ * Finds how far a body is drawn from where it actually is, given the
+ * current render interpolation.
+ */
+static vector_t render_offset(body_t *body) {
+  vector_t drawn = body_get_interpolated_centroid(body, render_alpha);
+  return vec_subtract(drawn, body_get_centroid(body));
+}
+
+/**
+ * Converts a color to an opaque SDL color.
+ */
+static SDL_Color opaque_color(color_t color) {
+  assert(0 <= color.red && color.red <= 1);
+  assert(0 <= color.green && color.green <= 1);
+  assert(0 <= color.blue && color.blue <= 1);
+  return (SDL_Color){color.red * 255, color.green * 255, color.blue * 255,
+                     255};
+}
+
 void sdl_draw_body(body_t *body) {
-  // Check parameters
-  list_t *points = body_get_shape(body);
-  size_t n = list_size(points);
+  const polygon_t *polygon = body_get_polygon(body);
+  const double *xs = polygon_xs(polygon);
+  const double *ys = polygon_ys(polygon);
+  size_t n = polygon->num_vertices;
   assert(n >= 3);
-  color_t color = body_get_color(body);
-  double r = color.red;
-  double g = color.green;
-  double b = color.blue;
+  SDL_Color color = opaque_color(body_get_color(body));
+  vector_t window_center = get_window_center();
+  vector_t offset = render_offset(body);
 
-  assert(0 <= r && r <= 1);
-  assert(0 <= g && g <= 1);
-  assert(0 <= b && b <= 1);
+  // the body is convex, so a fan from its first vertex fills it
+  primitive_batch_t *batch = reserve_batch(color, n, 3 * (n - 2));
+  size_t base = batch->num_vertices;
+  for (size_t i = 0; i < n; i++) {
+    vector_t point = {xs[i] + offset.x, ys[i] + offset.y};
+    vector_t pixel = get_window_position(point, window_center);
+    push_vertex(batch, pixel.x, pixel.y, color);
+  }
+  for (size_t i = 1; i + 1 < n; i++) {
+    push_triangle(batch, base, 0, i, i + 1);
+  }
+}
 
+void sdl_draw_ground(const vector_t *surface, size_t n, double bottom,
+                     color_t ground_color) {
+  assert(n >= 2);
+  SDL_Color color = opaque_color(ground_color);
   vector_t window_center = get_window_center();
 
-  // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
+  // a top and a bottom vertex per surface vertex, and a quad under each edge
+  primitive_batch_t *batch = reserve_batch(color, 2 * n, 6 * (n - 1));
+  size_t base = batch->num_vertices;
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
-    x_points[i] = pixel.x;
-    y_points[i] = pixel.y;
+    vector_t top = get_window_position(surface[i], window_center);
+    vector_t under = get_window_position((vector_t){surface[i].x, bottom},
+                                         window_center);
+    push_vertex(batch, top.x, top.y, color);
+    push_vertex(batch, under.x, under.y, color);
+  }
+  for (size_t i = 0; i + 1 < n; i++) {
+    push_triangle(batch, base, 2 * i, 2 * i + 2, 2 * i + 3);
+    push_triangle(batch, base, 2 * i, 2 * i + 3, 2 * i + 1);
   }
-
-  // Draw body with the given color
-  filledPolygonRGBA(renderer, x_points, y_points, n, r * 255, g * 255, b * 255,
-                    255);
-  free(x_points);
-  free(y_points);
-  free(points);
 }
 
 SDL_Texture *sdl_get_image_texture(const char *image_path) {
@@ -265,78 +445,92 @@ void sdl_show(void) {
            min = vec_subtract(center, max_diff);
   vector_t max_pixel = get_window_position(max, window_center),
            min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
-  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  SDL_RenderDrawRect(renderer, boundary);
-  free(boundary);
+  SDL_Color black = {0, 0, 0, 255};
+  sdl_batch_line(min_pixel.x, max_pixel.y, max_pixel.x, max_pixel.y, black);
+  sdl_batch_line(max_pixel.x, max_pixel.y, max_pixel.x, min_pixel.y, black);
+  sdl_batch_line(max_pixel.x, min_pixel.y, min_pixel.x, min_pixel.y, black);
+  sdl_batch_line(min_pixel.x, min_pixel.y, min_pixel.x, max_pixel.y, black);
+  sdl_batch_flush();
 
   SDL_RenderPresent(renderer);
 }
 
+SDL_Rect get_visible_rect(void) {
+  SDL_Rect viewport;
+  float scale_x, scale_y;
+  int out_w, out_h;
+  SDL_RenderGetViewport(renderer, &viewport);
+  SDL_RenderGetScale(renderer, &scale_x, &scale_y);
+  SDL_GetRendererOutputSize(renderer, &out_w, &out_h);
+
+  SDL_Rect on_window = {.x = -viewport.x,
+                        .y = -viewport.y,
+                        .w = ceil(out_w / scale_x),
+                        .h = ceil(out_h / scale_y)};
+  SDL_Rect in_viewport = {.x = 0, .y = 0, .w = viewport.w, .h = viewport.h};
+  SDL_Rect visible;
+  if (!SDL_IntersectRect(&on_window, &in_viewport, &visible)) {
+    return (SDL_Rect){0, 0, 0, 0};
+  }
+  return visible;
+}
+
+/**
+ * Draws a body if it is on the RENDER_SHAPE render layer and its bounding box
+ * overlaps the visible part of the world.
+ *
+ * @param body the body to draw
+ * @param visible the visible rectangle (see get_visible_rect())
+ */
+static void render_if_visible(body_t *body, const SDL_Rect *visible) {
+  if (body_is_removed(body) ||
+      !(body_get_render_layers(body) & RENDER_SHAPE)) {
+    return;
+  }
+  SDL_Rect bounds = sdl_get_body_bounding_box(body);
+  if (SDL_HasIntersection(&bounds, visible)) {
+    sdl_draw_body(body);
+  }
+}
+
 void sdl_render_scene(scene_t *scene) {
+  SDL_Rect visible = get_visible_rect();
   size_t body_count = scene_bodies(scene);
   for (size_t i = 0; i < body_count; i++) {
-    body_t *body = scene_get_body(scene, i);
-    if (body_is_removed(body)) {
-      continue;
-    }
-    char *info = body_get_info(body);
-    if (info) {
-      if (strcmp(info, GND_INFO) != 0 && strcmp(info, ARR_INFO) != 0 &&
-          strcmp(info, "particle") != 0) {
-        continue;
-      }
-    }
+    render_if_visible(scene_get_body(scene, i), &visible);
+  }
+}
 
-    sdl_draw_body(body);
+void sdl_render_bodies(body_t *const *bodies, size_t n) {
+  SDL_Rect visible = get_visible_rect();
+  for (size_t i = 0; i < n; i++) {
+    render_if_visible(bodies[i], &visible);
   }
 }
 
 void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 
 double time_since_last_tick(void) {
-  clock_t now = clock();
-  double difference = last_clock
-                          ? (double)(now - last_clock) / CLOCKS_PER_SEC
-                          : 0.0; // return 0 the first time this is called
-  last_clock = now;
+  // the performance counter is monotonic wall time, unlike clock(), which
+  // counts CPU time and so runs slow whenever the process is not busy
+  uint64_t now = SDL_GetPerformanceCounter();
+  double difference =
+      last_counter
+          ? (double)(now - last_counter) / SDL_GetPerformanceFrequency()
+          : 0.0; // return 0 the first time this is called
+  last_counter = now;
   return difference;
 }
 
-SDL_Rect sdl_get_body_bounding_box(body_t *body) {
-  double max_x = -__DBL_MAX__;
-  double max_y = -__DBL_MAX__;
-  double min_x = __DBL_MAX__;
-  double min_y = __DBL_MAX__;
-
-  list_t *body_vecs = body_get_shape(body);
-  size_t n = list_size(body_vecs);
-  for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(body_vecs, i);
+void sdl_set_interpolation(double alpha) { render_alpha = alpha; }
 
-    // find the maximum bounds of the star
-    if (vertex->x > max_x) {
-      max_x = vertex->x;
-    }
-    if (vertex->x < min_x) {
-      min_x = vertex->x;
-    }
-    if (vertex->y > max_y) {
-      max_y = vertex->y;
-    }
-    if (vertex->y < min_y) {
-      min_y = vertex->y;
-    }
-  }
-
-  list_free(body_vecs);
-
-  vector_t world_tl = {.x = min_x, .y = max_y};
-  vector_t world_br = {.x = max_x, .y = min_y};
+SDL_Rect sdl_get_body_bounding_box(body_t *body) {
+  aabb_t box = body_get_aabb(body);
+  vector_t offset = render_offset(body);
+  box.min = vec_add(box.min, offset);
+  box.max = vec_add(box.max, offset);
+  vector_t world_tl = {.x = box.min.x, .y = box.max.y};
+  vector_t world_br = {.x = box.max.x, .y = box.min.y};
 
   vector_t center = get_window_center();
   vector_t screen_tl = get_window_position(world_tl, center);
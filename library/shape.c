@@ -0,0 +1,53 @@
+#include "shape.h"
+#include "polygon.h"
+#include "vector.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+typedef struct shape {
+  polygon_t polygon;
+  double area;
+  size_t refs;
+} shape_t;
+
+shape_t *shape_init(const vector_t *vertices, size_t n, vector_t *centroid) {
+  shape_t *shape = malloc(sizeof(shape_t));
+  assert(shape);
+  polygon_t given;
+  polygon_init(&given);
+  polygon_set(&given, vertices, n);
+  vector_t center = polygon_centroid(&given);
+  shape->area = fabs(polygon_signed_area(&given));
+
+  // move the centroid to the origin
+  polygon_init(&shape->polygon);
+  polygon_transform(&shape->polygon, &given, vec_negate(center), 1, 0);
+  polygon_free(&given);
+  shape->refs = 1;
+  if (centroid) {
+    *centroid = center;
+  }
+  return shape;
+}
+
+shape_t *shape_retain(shape_t *shape) {
+  shape->refs++;
+  return shape;
+}
+
+void shape_release(shape_t *shape) {
+  assert(shape->refs > 0);
+  shape->refs--;
+  if (shape->refs == 0) {
+    polygon_free(&shape->polygon);
+    free(shape);
+  }
+}
+
+const polygon_t *shape_get_polygon(const shape_t *shape) {
+  return &shape->polygon;
+}
+
+double shape_area(const shape_t *shape) { return shape->area; }
@@ -72,8 +72,6 @@ void shoot_drag(turn_engine_t *eng, double mouse_x, double mouse_y) {
     drag = MAX_DRAG_DIST;
   }
 
-  vector_t accel = vec_add(eng->level->gravity, eng->level->wind);
-
   body_t *shooter =
       scene_get_body(eng->level->scene, eng->p_body_idx[PLAYER_ONE]);
   arrow_variant_t variant = eng->equipped_arrow;
@@ -84,17 +82,13 @@ void shoot_drag(turn_engine_t *eng, double mouse_x, double mouse_y) {
   double vel_scale = arrow_vel_scale(variant);
   vector_t vel = vec_multiply(drag * SHOT_POWER * vel_scale, dir);
   for (size_t i = 0; i < PREVIEW_DOTS; i++) {
-    vel = vec_add(vel, vec_multiply(PREVIEW_DT, accel));
-    pos = vec_add(pos, vec_multiply(PREVIEW_DT, vel));
+    level_predict_flight(eng->level, &pos, &vel, PREVIEW_DT);
     preview_pts[preview_cnt] = pos;
     preview_cnt++;
   }
 }
 
 void shoot_render_preview(camera_t *cam) {
-  SDL_Renderer *ren = sdl_get_renderer();
-  SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
-
   for (size_t i = 0; i < preview_cnt; i++) {
     vector_t scr = camera_world_to_screen(cam, preview_pts[i]);
     if (fabs(cam->zoom - ZOOM) < ZOOM_THRESHOLD) {
@@ -122,20 +116,23 @@ void shoot_end(turn_engine_t *eng, body_t *shooter, double mouse_x,
     dist = MAX_DRAG_DIST;
   }
   vector_t vel = vec_multiply(dist * SHOT_POWER, dir);
+  shoot_fire(eng, shooter, vel);
+}
 
+void shoot_fire(turn_engine_t *eng, body_t *shooter, vector_t vel) {
   arrow_variant_t v = eng->equipped_arrow;
   if (v == ARROW_MULTI) {
     double offset = 7.0 * M_PI / 180;
     const double angles[3] = {-offset, 0, offset};
     for (size_t i = 0; i < 3; i++) {
       vector_t velocity = vec_rotate(vel, angles[i]);
-      body_t *arr = arrow_spawn(eng->level->scene, shooter, velocity, v);
+      body_t *arr = arrow_spawn(eng->level, shooter, velocity, v);
       if (i == 1) {
         turn_engine_register_arrow(eng, arr);
       }
     }
   } else {
-    body_t *arr = arrow_spawn(eng->level->scene, shooter, vel, v);
+    body_t *arr = arrow_spawn(eng->level, shooter, vel, v);
     turn_engine_register_arrow(eng, arr);
   }
 }
\ No newline at end of file
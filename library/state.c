@@ -4,8 +4,10 @@
 #include "asset_cache.h"
 #include "color.h"
 #include "crate.h"
+#include "fixed_step.h"
 #include "hud.h"
 #include "input.h"
+#include "player.h"
 #include "shoot.h"
 #include "turn_engine.h"
 #include "vector.h"
@@ -18,19 +20,11 @@
 const size_t FOREST_LEVEL_IDX = 0;
 const size_t MESA_LEVEL_IDX = 1;
 const size_t MOON_LEVEL_IDX = 2;
+const size_t MOON_WIDE_LEVEL_IDX = 3;
 
-const color_t P1_COLOR = {.blue = 1, .green = 0, .red = 0};
-const color_t P2_COLOR = {.blue = 0, .green = 0, .red = 1};
-const double PLAYER_HALF_PX = 32;
 const double ZOOMED = 1.4;
-const vector_t PLAYER_HITBOX[4] = {{-PLAYER_HALF_PX, -PLAYER_HALF_PX},
-                                   {PLAYER_HALF_PX, -PLAYER_HALF_PX},
-                                   {PLAYER_HALF_PX, PLAYER_HALF_PX},
-                                   {-PLAYER_HALF_PX, PLAYER_HALF_PX}};
-const size_t PLAYER_HITBOX_PTS = 4;
-const double PLAYER_MASS = INFINITY;
-const double PLAYER_X_POS = 100;
-const int32_t PLAYER_HP = 100;
+// how far past each side of the view to keep ground streamed in, in views
+const double GROUND_STREAM_MARGIN = 0.5;
 
 const size_t BUTTON_WIDTH = 200;
 const size_t BUTTON_HEIGHT = 150;
@@ -76,14 +70,18 @@ const SDL_Rect BACK_BTN = {0, 0, 150, 100};
 const SDL_Rect FOREST_BTN = {375, 150, 250, 150};
 const SDL_Rect MESA_BTN = {50, 150, 250, 150};
 const SDL_Rect MOON_BTN = {700, 150, 250, 150};
+// the ten-screen moon reuses the moon's button, labelled beside it
+const SDL_Rect MOON_WIDE_BTN = {375, 325, 250, 150};
+const SDL_Rect MOON_WIDE_LABEL = {640, 380, 150, 40};
+const char *MOON_WIDE_MSG = "10x WIDE";
 
-const char *P1_PATH = "assets/blue_archer.png";
-const char *P2_PATH = "assets/red_archer.png";
+const char *PLAYER_IMGS[] = {"assets/blue_archer.png",
+                             "assets/red_archer.png"};
 
 void push_winner_label(player_id_t winner, vector_t screen_min,
                        vector_t screen_max) {
   const char *msg = (winner == PLAYER_ONE) ? "P1 WINS :D" : "P2 WINS :(";
-  color_t color = (winner == PLAYER_ONE) ? P1_COLOR : P2_COLOR;
+  color_t color = player_color(winner);
 
   size_t mid_x = ((screen_min.x + screen_max.x) * 0.5);
   size_t mid_y = ((screen_min.y + screen_max.y) * 0.5);
@@ -115,8 +113,18 @@ void render_play_screen(state_t *state, list_t *assets, double dt) {
     }
   }
 
+  vector_t view_min, view_max;
+  camera_get_view(state->cam, &view_min, &view_max);
+  double margin = (view_max.x - view_min.x) * GROUND_STREAM_MARGIN;
+  level_stream_ground(state->level, view_min.x - margin, view_max.x + margin);
+
   camera_apply(state->cam);
+  level_render_ground(state->level);
   sdl_render_scene(state->level->scene);
+  level_render_bodies(state->level);
+  // the ground and bodies are batched; draw them before the sprites go on
+  // top and while the camera is still applied
+  sdl_batch_flush();
   for (size_t i = 0; i < list_size(assets); i++) {
     asset_t *a = list_get(assets, i);
     if (asset_get_type(a) == ASSET_IMAGE && asset_get_body(a) != NULL) {
@@ -127,6 +135,8 @@ void render_play_screen(state_t *state, list_t *assets, double dt) {
   camera_reset(state->cam);
   if (state->eng->active == PLAYER_ONE) {
     shoot_render_preview(state->cam);
+    // the HUD goes on top of the preview
+    sdl_batch_flush();
   }
   hud_draw(state->eng);
   for (size_t i = 0; i < list_size(assets); i++) {
@@ -135,7 +145,7 @@ void render_play_screen(state_t *state, list_t *assets, double dt) {
       asset_render(a);
     }
   }
-  arrow_render_particles();
+  arrow_render_particles(state->level);
   sdl_show();
 }
 
@@ -164,6 +174,9 @@ void push_arena_select_assets() {
   asset_make_image(FOREST_BTN_IMG, FOREST_BTN);
   asset_make_image(MESA_BTN_IMG, MESA_BTN);
   asset_make_image(MOON_BTN_IMG, MOON_BTN);
+  asset_make_image(MOON_BTN_IMG, MOON_WIDE_BTN);
+  asset_make_text(SCREEN_FONT, MOON_WIDE_LABEL, MOON_WIDE_MSG,
+                  START_SCREEN_COLOR);
   asset_make_image(BACK_BTN_IMG, BACK_BTN);
 }
 
@@ -178,40 +191,40 @@ void push_gameover_assets() {
   asset_make_image("assets/main_menu.png", reset_box);
 }
 
-body_t *make_player(vector_t pos, double mass, color_t color,
-                    const char *img_path) {
-  list_t *vertices = list_init(PLAYER_HITBOX_PTS, free);
-  for (size_t i = 0; i < PLAYER_HITBOX_PTS; i++) {
-    vector_t *v = malloc(sizeof(vector_t));
-    *v = (vector_t){pos.x + PLAYER_HITBOX[i].x, pos.y + PLAYER_HITBOX[i].y};
-    list_add(vertices, v);
-  }
-  int32_t *hp = malloc(sizeof(int32_t));
-  *hp = PLAYER_HP;
-  body_t *body = body_init_with_info(vertices, mass, color, hp, free);
-  asset_make_image_with_body(img_path, body);
+body_t *make_player(player_id_t id, vector_t spawn) {
+  body_t *body = player_init(id, spawn);
+  body_set_render_layers(body, RENDER_SPRITE);
+  asset_make_image_with_body(PLAYER_IMGS[id], body);
   return body;
 }
 
 void push_play_assets(state_t *state, size_t level_idx) {
+  const char *path = state->level_paths[level_idx];
+  state->level = level_init(path);
+  if (!state->level) {
+    // stay on the arena select screen
+    fprintf(stderr, "could not load level %s\n", path);
+    return;
+  }
   asset_reset_asset_list();
-  const level_info_t info = state->level_info[level_idx];
-  state->level = level_init(info);
-  state->cam = camera_init(info.screen_min, info.screen_max);
-
-  double p1_x = info.screen_min.x + PLAYER_X_POS;
-  double p2_x = info.screen_max.x - PLAYER_X_POS;
-  double p1_y = level_ground_height(state->level, p1_x);
-  double p2_y = level_ground_height(state->level, p2_x);
-  vector_t p1_pos = {p1_x, p1_y + PLAYER_HALF_PX};
-  vector_t p2_pos = {p2_x, p2_y + PLAYER_HALF_PX};
-  body_t *p2 = make_player(p2_pos, PLAYER_MASS, P2_COLOR, P2_PATH);
-  body_t *p1 = make_player(p1_pos, PLAYER_MASS, P1_COLOR, P1_PATH);
+  const level_info_t info = state->level->info;
+  // the background is drawn in screen space, so it only covers the window
+  vector_t window = vec_multiply(2, get_window_center());
+  SDL_Rect bg_rect = {0, 0, window.x, window.y};
+  asset_make_image(info.background_path, bg_rect);
+  // the camera shows a window's worth of the arena, which may be wider
+  state->cam = camera_init(info.screen_min, vec_add(info.screen_min, window));
+  camera_set_bounds(state->cam, info.screen_min, info.screen_max);
+
+  const level_file_t *file = state->level->file;
+  assert(file->header->num_spawns >= 2);
+  body_t *p2 = make_player(PLAYER_TWO, file->spawns[1]);
+  body_t *p1 = make_player(PLAYER_ONE, file->spawns[0]);
   size_t p1_idx = scene_bodies(state->level->scene);
   size_t p2_idx = p1_idx + 1;
 
-  scene_add_body(state->level->scene, p1);
-  scene_add_body(state->level->scene, p2);
+  level_add_body(state->level, p1);
+  level_add_body(state->level, p2);
 
   state->eng =
       turn_engine_init(state->level, state->cam, info.turn_len, p1_idx, p2_idx);
@@ -219,17 +232,19 @@ void push_play_assets(state_t *state, size_t level_idx) {
   state->overlay = OVERLAY_NONE;
 }
 
-state_t *state_init(const level_info_t levels[], size_t num_levels) {
+state_t *state_init(const char *level_paths[], size_t num_levels,
+                    double sim_rate, size_t max_steps) {
   srand(time(0));
   state_t *state =
-      calloc(1, sizeof(state_t) + num_levels * sizeof(level_info_t));
+      calloc(1, sizeof(state_t) + num_levels * sizeof(const char *));
   assert(state);
 
   for (size_t i = 0; i < num_levels; i++) {
-    state->level_info[i] = levels[i];
+    state->level_paths[i] = level_paths[i];
   }
   state->screen = SCREEN_START;
   state->overlay = OVERLAY_NONE;
+  state->stepper = fixed_step_init(sim_rate, max_steps);
   push_start_screen_assets(state);
 
   return state;
@@ -243,6 +258,7 @@ void state_free(state_t *state) {
     turn_engine_destroy(state->eng);
   }
   asset_reset_asset_list();
+  fixed_step_free(state->stepper);
   free(state);
 }
 
@@ -269,11 +285,13 @@ void state_mouse_handler(state_t *state, mouse_event_type_t type,
         return;
       }
       if (sdl_in_rect(mouse_x, mouse_y, FOREST_BTN)) {
-        push_play_assets(state, FOREST);
+        push_play_assets(state, FOREST_LEVEL_IDX);
       } else if (sdl_in_rect(mouse_x, mouse_y, MESA_BTN)) {
-        push_play_assets(state, MESA);
+        push_play_assets(state, MESA_LEVEL_IDX);
       } else if (sdl_in_rect(mouse_x, mouse_y, MOON_BTN)) {
-        push_play_assets(state, MOON);
+        push_play_assets(state, MOON_LEVEL_IDX);
+      } else if (sdl_in_rect(mouse_x, mouse_y, MOON_WIDE_BTN)) {
+        push_play_assets(state, MOON_WIDE_LEVEL_IDX);
       }
       return;
     }
@@ -341,10 +359,16 @@ void state_tick(state_t *state, double dt) {
   case SCREEN_PLAY:
     if (state->level) {
       list_t *assets = asset_get_asset_list();
-      level_tick(state->level, dt);
-      turn_engine_update(state->eng, dt);
-      arrow_update_particles(state->level, dt, state->eng->equipped_arrow);
+      size_t steps = fixed_step_advance(state->stepper, dt);
+      double step_dt = fixed_step_dt(state->stepper);
+      turn_engine_begin_frame(state->eng);
+      for (size_t i = 0; i < steps; i++) {
+        level_tick(state->level, step_dt);
+        turn_engine_update(state->eng, step_dt);
+        arrow_update_particles(state->level, step_dt);
+      }
 
+      sdl_set_interpolation(fixed_step_alpha(state->stepper));
       render_play_screen(state, assets, dt);
     }
 
@@ -358,10 +382,10 @@ void state_tick(state_t *state, double dt) {
 
     if (hp1 <= 0 || hp2 <= 0) {
       player_id_t winner = (hp2 <= 0 && hp1 > 0) ? PLAYER_ONE : PLAYER_TWO;
+      vector_t min = state->level->info.screen_min;
+      vector_t max = state->level->info.screen_max;
       push_gameover_assets();
       turn_engine_destroy(state->eng);
-      vector_t min = state->level_info[FOREST_LEVEL_IDX].screen_min;
-      vector_t max = state->level_info[FOREST_LEVEL_IDX].screen_max;
       push_winner_label(winner, min, max);
       state->screen = SCREEN_GAME_OVER;
     }
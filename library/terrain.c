@@ -0,0 +1,92 @@
+#include "terrain.h"
+#include "vector.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// arena constants
+// surface vertices are this far apart however wide the arena is
+const double GROUND_VERTEX_SPACING = 5.0;
+const size_t ARENA_HEIGHT = 100;
+
+const double FOREST_HILL_HEIGHT = 90.0;
+const double FOREST_HILL_HALFWIDTH = 180.0;
+
+const double MESA_TOP_HEIGHT = 80.0;
+const double MESA_LOW_HEIGHT = 0;
+const double MESA_CLIFF_RATIO = 0.45;
+const double MESA_CLIFF_WIDTH = 10;
+
+const double MOON_CRATER_DEPTH = 80.0;
+const double MOON_CRATER_HALFWIDTH = 200.0;
+const double MOON_LIP_HEIGHT = 75.0;
+const double MOON_LIP_OFFSET = 260.0;
+const double MOON_LIP_HALFWIDTH = 60.0;
+
+double forest_height(double x, double w) {
+  return ARENA_HEIGHT +
+         FOREST_HILL_HEIGHT *
+             exp(-pow((x - 0.5 * w) / FOREST_HILL_HALFWIDTH, 2.0));
+}
+
+double mesa_height(double x, double w) {
+  if (x < MESA_CLIFF_RATIO * w) {
+    return ARENA_HEIGHT + MESA_LOW_HEIGHT;
+  } else {
+    return ARENA_HEIGHT + MESA_TOP_HEIGHT;
+  }
+}
+
+double moon_height(double x, double w) {
+  double y =
+      ARENA_HEIGHT -
+      (MOON_CRATER_DEPTH * exp(-pow((x - 0.5 * w) / MOON_CRATER_HALFWIDTH, 2)));
+  return y + MOON_LIP_HEIGHT * exp(-pow((fabs(x - 0.5 * w) - MOON_LIP_OFFSET) /
+                                            MOON_LIP_HALFWIDTH,
+                                        2));
+}
+
+double terrain_height(level_type_t type, double x, double w) {
+  switch (type) {
+  case FOREST:
+    return forest_height(x, w);
+  case MESA:
+    return mesa_height(x, w);
+  case MOON:
+    return moon_height(x, w);
+  default:
+    return ARENA_HEIGHT;
+  }
+}
+
+vector_t *terrain_surface(level_type_t type, vector_t screen_min,
+                          vector_t screen_max, size_t *num_vertices) {
+  double w = screen_max.x - screen_min.x;
+  size_t num_columns = round(w / GROUND_VERTEX_SPACING) + 1;
+  double dx = w / (double)(num_columns - 1);
+  // room for the two extra vertices of the mesa's cliff
+  vector_t *verts = malloc(sizeof(vector_t) * (num_columns + 2));
+  assert(verts);
+  size_t n = 0;
+
+  double cliff_x = MESA_CLIFF_RATIO * w;
+  bool cliff_inserted = false;
+
+  for (size_t i = 0; i < num_columns; i++) {
+    double x = screen_min.x + i * dx;
+    if (type == MESA && !cliff_inserted && x >= cliff_x) {
+      verts[n++] = (vector_t){cliff_x, ARENA_HEIGHT + MESA_LOW_HEIGHT};
+      verts[n++] = (vector_t){cliff_x, ARENA_HEIGHT + MESA_TOP_HEIGHT};
+      cliff_inserted = true;
+    }
+    double y = terrain_height(type, x, w);
+    if (i == 0 || i == num_columns - 1) {
+      y = ARENA_HEIGHT;
+    }
+    verts[n++] = (vector_t){x, y};
+  }
+  *num_vertices = n;
+  return verts;
+}
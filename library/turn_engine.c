@@ -1,5 +1,6 @@
 #include "turn_engine.h"
 #include "arrow.h"
+#include "ballistic.h"
 #include "crate.h"
 #include "sdl_wrapper.h"
 #include <SDL2/SDL.h>
@@ -14,40 +15,94 @@ const double CAM_OFFSET_Y = 70;
 
 const double DT = 0.05;        // time step for arrow integral approximation
 const double SIM_TIME = 4.0;   // time interval to integrate arrow path over
-const size_t SAMPLES = 50;     // 50 sample monte carlo simulation
 const double SHOT_SCALE = 5.0; // shot power multiplier
 const double MIN_SPEED = SHOT_SCALE * 60.0;
 const double MAX_SPEED = SHOT_SCALE * 200.0;
 const double MIN_ANGLE = 10.0 * M_PI / 180.0;
 const double MAX_ANGLE = 80 * M_PI / 180.0;
-const double BATCH_SIZE = 10; // how many AI samples per frame
+// most times the CPU corrects its aim for drag and field zones per speed
+const size_t CPU_AIM_PASSES = 4;
+// how close to the target's centroid a simulated shot must pass
+const double CPU_HIT_TOLERANCE = 8.0;
+// threads searching for the CPU's shot alongside the main thread, set by
+// the Makefile in threaded builds
+#ifdef CPU_SEARCH_THREADS
+const size_t NUM_CPU_SEARCH_THREADS = CPU_SEARCH_THREADS;
+#else
+const size_t NUM_CPU_SEARCH_THREADS = 0;
+#endif
+// seconds of wall-clock time the search may take per frame, shared by all
+// of the frame's fixed steps; headless matches search to the end in one go
+const double CPU_FRAME_BUDGET = 0.001;
+// times refinement halves its step around the closest miss
+const size_t CPU_REFINE_STEPS = 8;
 const double MIN_AI_TURN_TIME = 5;
+const double BURST_ANIMATION_TIME = 3.0;
 
 const double CRATE_SPAWN_CHANCE = 0.30;
 
+enum {
+  // launch speeds in the search's grid, evenly spaced from MIN_SPEED to
+  // MAX_SPEED
+  CPU_GRID_SPEEDS = 64,
+  // most shots tried at once on the worker pool
+  CPU_BATCH_SIZE = 8
+};
+
+/**
+ * One launch speed the CPU tries, and the best aim it found at that speed.
+ */
+typedef struct {
+  double speed;
+  double angle;
+  // squared distance the shot misses by, or INFINITY if there is no clear
+  // arc at this speed
+  double err;
+  // how far from the target the shot aimed to make up for drag and field
+  // zones; set beforehand to where to start
+  vector_t offset;
+} cpu_shot_t;
+
+/**
+ * Shots the CPU tries together, and what the search threads share. They
+ * only read the level, and each shot is written only by the thread trying
+ * it, so a batch turns out the same however many threads there are.
+ */
+typedef struct {
+  level_t *level;
+  vector_t shooter;
+  vector_t target;
+  // gravity plus wind
+  vector_t accel;
+  // whether accel is all there is, i.e. no drag and no field zones
+  bool exact;
+  size_t count;
+  cpu_shot_t shots[CPU_BATCH_SIZE];
+} cpu_batch_t;
+
+/**
+ * Whether the engine is running without a camera (see turn_engine_init()),
+ * in which case nothing waits on animations.
+ */
+static bool is_headless(const turn_engine_t *eng) { return !eng->cam; }
+
 void put_camera_on_p1(turn_engine_t *eng) {
   camera_t *cam = eng->cam;
+  if (is_headless(eng)) {
+    return;
+  }
 
   double half_w = (cam->screen_max.x - cam->screen_min.x) * 0.5 / cam->zoom;
   double half_h = (cam->screen_max.y - cam->screen_min.y) * 0.5 / cam->zoom;
 
-  double cam_x = cam->screen_min.x + half_w;
+  double cam_x = cam->world_min.x + half_w;
   body_t *p = scene_get_body(eng->level->scene, eng->p_body_idx[PLAYER_ONE]);
   double player_y = body_get_centroid(p).y;
   double cam_y =
-      fmax(player_y, cam->screen_min.y + half_h) + CAM_OFFSET_Y * CAM_ZOOM;
+      fmax(player_y, cam->world_min.y + half_h) + CAM_OFFSET_Y * CAM_ZOOM;
   camera_set_center(cam, (vector_t){cam_x, cam_y});
 }
 
-bool scene_contains_body(scene_t *scene, const body_t *body) {
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    if (scene_get_body(scene, i) == body) {
-      return true;
-    }
-  }
-  return false;
-}
-
 double rand_double(double min, double max) {
   double rand_unit = (double)rand() / ((double)RAND_MAX + 1.0);
   return min + (max - min) * rand_unit;
@@ -64,25 +119,32 @@ vector_t rand_wind(turn_engine_t *eng) {
 
 void start_cpu_search(turn_engine_t *eng) {
   eng->cpu_pending = true;
-  eng->cpu_sample_idx = 0;
-  eng->cpu_best_err = __DBL_MAX__;
+  eng->cpu_phase = CPU_SEARCH_WARM;
+  eng->cpu_step = 0;
+  eng->cpu_best_err = INFINITY;
 }
 
 void enter_player_mode(turn_engine_t *eng) {
   eng->cam_mode = CAM_PLAYER;
+  if (eng->active == PLAYER_TWO) {
+    start_cpu_search(eng);
+  }
+  if (is_headless(eng)) {
+    return;
+  }
   if (eng->active == PLAYER_ONE) {
     camera_set_zoom(eng->cam, CAM_ZOOM);
-    put_camera_on_p1(eng);
   } else {
     camera_set_zoom(eng->cam, CAM_NORMAL);
-    put_camera_on_p1(eng);
-    start_cpu_search(eng);
   }
   put_camera_on_p1(eng);
 }
 
 void enter_arrow_mode(turn_engine_t *eng) {
   eng->cam_mode = CAM_ARROW;
+  if (is_headless(eng)) {
+    return;
+  }
   camera_set_zoom(eng->cam, CAM_NORMAL);
   if (eng->active == PLAYER_ONE) {
     vector_t arrow_pos = body_get_centroid(eng->tracked_arrow);
@@ -91,6 +153,9 @@ void enter_arrow_mode(turn_engine_t *eng) {
 }
 
 void sync_zoom(turn_engine_t *eng) {
+  if (is_headless(eng)) {
+    return;
+  }
   if (eng->cam_mode != CAM_PLAYER || eng->active == PLAYER_TWO) {
     camera_set_zoom(eng->cam, CAM_NORMAL);
     return;
@@ -100,27 +165,257 @@ void sync_zoom(turn_engine_t *eng) {
   put_camera_on_p1(eng);
 }
 
-double try_shot(turn_engine_t *eng, double angle, double speed) {
-  vector_t accel = vec_add(eng->level->gravity, eng->level->wind);
-
-  body_t *p2 = scene_get_body(eng->level->scene, eng->p_body_idx[PLAYER_TWO]);
-  vector_t pos = body_get_centroid(p2);
-  vector_t vel = {speed * cos(angle), speed * sin(angle)};
-
-  body_t *target =
-      scene_get_body(eng->level->scene, eng->p_body_idx[PLAYER_ONE]);
-  vector_t target_pos = body_get_centroid(target);
+/**
+ * @param shooter player two's centroid
+ * @param angle a launch angle
+ * @return where arrow_spawn() puts an arrow shot at that angle by player two
+ */
+static vector_t cpu_launch_point(vector_t shooter, double angle) {
+  vector_t dir = {cos(angle), sin(angle)};
+  return vec_add(shooter,
+                 vec_multiply(arrow_front_offset(ARROW_STANDARD), dir));
+}
 
+/**
+ * Flies a shot through the level's force field the way arrows are
+ * integrated, until it reaches the target's x position or comes down on the
+ * terrain, whichever is first.
+ *
+ * @param batch the batch the shot is part of
+ * @param angle the launch angle
+ * @param launch_speed the speed the arrow leaves the bow at
+ * @return where the shot passes the target, or where it lands short of it
+ */
+static vector_t simulate_shot(const cpu_batch_t *batch, double angle,
+                              double launch_speed) {
+  vector_t target = batch->target;
+  vector_t pos = cpu_launch_point(batch->shooter, angle);
+  vector_t vel = {launch_speed * cos(angle), launch_speed * sin(angle)};
+  double side = target.x < pos.x ? -1 : 1;
   for (double t = 0; t < SIM_TIME; t += DT) {
-    vel = vec_add(vel, vec_multiply(DT, accel));
-    pos = vec_add(pos, vec_multiply(DT, vel));
+    vector_t prev = pos;
+    level_predict_flight(batch->level, &pos, &vel, DT);
+    if ((pos.x - target.x) * side >= 0) {
+      double frac = (target.x - prev.x) / (pos.x - prev.x);
+      return vec_add(prev, vec_multiply(frac, vec_subtract(pos, prev)));
+    }
+    if (pos.y - 3.0 <= level_ground_height(batch->level, pos.x)) {
+      break;
+    }
+  }
+  return pos;
+}
+
+/**
+ * Finds the fastest arc at a given speed that passes through a point,
+ * leaves the bow between MIN_ANGLE and MAX_ANGLE above the horizontal, and
+ * clears the terrain, treating the level's gravity and wind as the only
+ * acceleration.
+ *
+ * @param batch the batch the arc is part of
+ * @param aim the point to pass through
+ * @param launch_speed the speed the arrow leaves the bow at
+ * @param angle set to the arc's launch angle, if there is one
+ * @return whether there is such an arc
+ */
+static bool solve_cpu_arc(const cpu_batch_t *batch, vector_t aim,
+                          double launch_speed, double *angle) {
+  vector_t start = batch->shooter;
+  ballistic_arc_t arcs[2];
+  size_t n = ballistic_solve(vec_subtract(aim, start), launch_speed,
+                             batch->accel, arcs);
+  for (size_t i = 0; i < n; i++) {
+    // the arrow starts a little way along the launch direction, which moves
+    // the arc slightly, so solve again from there
+    start = cpu_launch_point(batch->shooter, arcs[i].angle);
+    ballistic_arc_t refined[2];
+    size_t m = ballistic_solve(vec_subtract(aim, start), launch_speed,
+                               batch->accel, refined);
+    if (m == 0) {
+      continue;
+    }
+    ballistic_arc_t arc = refined[m == 2 ? i : 0];
+    double elevation = atan2(sin(arc.angle), fabs(cos(arc.angle)));
+    vector_t vel = {launch_speed * cos(arc.angle),
+                    launch_speed * sin(arc.angle)};
+    if (elevation >= MIN_ANGLE && elevation <= MAX_ANGLE &&
+        ballistic_clears_terrain(batch->level->ground, start, vel,
+                                 batch->accel, arc.time)) {
+      *angle = arc.angle;
+      return true;
+    }
+  }
+  return false;
+}
 
-    if (pos.y - 3.0 <= level_ground_height(eng->level, pos.x)) {
+/**
+ * Tries one shot of a batch, as a worker_task_t. The arc is solved in
+ * closed form for gravity and wind. If the level has drag or field zones,
+ * the arc is flown and the aim point moved by the miss until the shot
+ * passes close enough, a Newton step that takes the miss as changing one
+ * for one with the aim.
+ *
+ * @param index which shot to try
+ * @param aux the cpu_batch_t
+ */
+static void try_cpu_shot(size_t index, void *aux) {
+  cpu_batch_t *batch = aux;
+  cpu_shot_t *shot = &batch->shots[index];
+  double tolerance = CPU_HIT_TOLERANCE * CPU_HIT_TOLERANCE;
+  double launch_speed = shot->speed * arrow_vel_scale(ARROW_STANDARD);
+  vector_t offset = shot->offset;
+  shot->err = INFINITY;
+
+  for (size_t pass = 0; pass < CPU_AIM_PASSES; pass++) {
+    double angle;
+    vector_t aim = vec_add(batch->target, offset);
+    if (!solve_cpu_arc(batch, aim, launch_speed, &angle)) {
       break;
     }
+    vector_t miss = VEC_ZERO;
+    if (!batch->exact) {
+      miss = vec_subtract(batch->target,
+                          simulate_shot(batch, angle, launch_speed));
+    }
+    double err = vec_dot(miss, miss);
+    if (err < shot->err) {
+      shot->err = err;
+      shot->angle = angle;
+      shot->offset = offset;
+    }
+    if (err <= tolerance) {
+      break;
+    }
+    offset = vec_add(offset, miss);
+  }
+}
+
+/**
+ * Adds a shot to a batch.
+ *
+ * @param batch the batch
+ * @param speed the launch speed to try, between MIN_SPEED and MAX_SPEED
+ * @param offset how far from the target to aim at first
+ */
+static void add_cpu_shot(cpu_batch_t *batch, double speed, vector_t offset) {
+  assert(batch->count < CPU_BATCH_SIZE);
+  batch->shots[batch->count++] = (cpu_shot_t){
+      .speed = fmin(fmax(speed, MIN_SPEED), MAX_SPEED), .offset = offset};
+}
+
+/**
+ * Tries a batch of shots on the engine's worker pool, and keeps whichever
+ * misses by least if it beats the engine's best shot so far. Ties go to
+ * the shot added first.
+ *
+ * @param eng the turn engine
+ * @param batch the shots to try
+ */
+static void run_cpu_batch(turn_engine_t *eng, cpu_batch_t *batch) {
+  scene_t *scene = eng->level->scene;
+  const force_field_t *field = eng->level->field;
+  batch->level = eng->level;
+  batch->shooter = body_get_centroid(
+      scene_get_body(scene, eng->p_body_idx[PLAYER_TWO]));
+  batch->target = body_get_centroid(
+      scene_get_body(scene, eng->p_body_idx[PLAYER_ONE]));
+  batch->accel = vec_add(field->gravity, field->wind);
+  batch->exact = field->drag == 0 && field->num_zones == 0;
+  worker_pool_run(eng->cpu_workers, batch->count, try_cpu_shot, batch);
+
+  for (size_t i = 0; i < batch->count; i++) {
+    const cpu_shot_t *shot = &batch->shots[i];
+    if (shot->err < eng->cpu_best_err) {
+      eng->cpu_best_err = shot->err;
+      eng->cpu_best_angle = shot->angle;
+      eng->cpu_best_speed = shot->speed;
+      eng->cpu_best_offset = shot->offset;
+    }
   }
-  vector_t diff = vec_subtract(pos, target_pos);
-  return vec_dot(diff, diff);
+}
+
+/**
+ * Takes the CPU's search for its shot one batch further. It first tries
+ * the speed and aim of its previous shot, which still hits if the players
+ * and the wind have not changed much. Then it goes through a grid of
+ * speeds from slowest to fastest, stopping once one hits. If none does, it
+ * refines the speed of the closest miss by trying ever smaller steps to
+ * either side, several sizes per batch.
+ *
+ * Which batches are tried depends only on how earlier ones turned out, so
+ * the search picks the same shot however it is spread over frames.
+ */
+static void advance_cpu_search(turn_engine_t *eng) {
+  double spacing = (MAX_SPEED - MIN_SPEED) / (CPU_GRID_SPEEDS - 1);
+  cpu_batch_t batch = {.count = 0};
+  switch (eng->cpu_phase) {
+  case CPU_SEARCH_WARM:
+    if (eng->cpu_warm) {
+      add_cpu_shot(&batch, eng->cpu_warm_speed, eng->cpu_warm_offset);
+    }
+    eng->cpu_phase = CPU_SEARCH_GRID;
+    break;
+  case CPU_SEARCH_GRID:
+    while (batch.count < CPU_BATCH_SIZE && eng->cpu_step < CPU_GRID_SPEEDS) {
+      add_cpu_shot(&batch, MIN_SPEED + spacing * eng->cpu_step, VEC_ZERO);
+      eng->cpu_step++;
+    }
+    if (eng->cpu_step == CPU_GRID_SPEEDS) {
+      eng->cpu_phase = CPU_SEARCH_REFINE;
+      eng->cpu_step = 0;
+    }
+    break;
+  case CPU_SEARCH_REFINE:
+    if (eng->cpu_best_err == INFINITY || eng->cpu_step == CPU_REFINE_STEPS) {
+      eng->cpu_phase = CPU_SEARCH_DONE;
+      return;
+    }
+    // several step sizes at once around the same speed, to fill the pool
+    while (batch.count + 2 <= CPU_BATCH_SIZE &&
+           eng->cpu_step < CPU_REFINE_STEPS) {
+      eng->cpu_step++;
+      double step = ldexp(spacing, -(int)eng->cpu_step);
+      add_cpu_shot(&batch, eng->cpu_best_speed - step, eng->cpu_best_offset);
+      add_cpu_shot(&batch, eng->cpu_best_speed + step, eng->cpu_best_offset);
+    }
+    break;
+  case CPU_SEARCH_DONE:
+    return;
+  }
+
+  if (batch.count > 0) {
+    run_cpu_batch(eng, &batch);
+  }
+  if (eng->cpu_best_err <= CPU_HIT_TOLERANCE * CPU_HIT_TOLERANCE) {
+    eng->cpu_phase = CPU_SEARCH_DONE;
+  }
+}
+
+/**
+ * Fires player two's shot at the best aim the search found, and remembers
+ * it to start the next search from. If nothing could reach player one, it
+ * lobs as far as it can towards them instead.
+ */
+static void fire_cpu_shot(turn_engine_t *eng) {
+  scene_t *scene = eng->level->scene;
+  body_t *shooter = scene_get_body(scene, eng->p_body_idx[PLAYER_TWO]);
+  if (eng->cpu_best_err == INFINITY) {
+    vector_t target = body_get_centroid(
+        scene_get_body(scene, eng->p_body_idx[PLAYER_ONE]));
+    eng->cpu_best_angle =
+        target.x < body_get_centroid(shooter).x ? 3 * M_PI / 4 : M_PI / 4;
+    eng->cpu_best_speed = MAX_SPEED;
+  } else {
+    eng->cpu_warm = true;
+    eng->cpu_warm_speed = eng->cpu_best_speed;
+    eng->cpu_warm_offset = eng->cpu_best_offset;
+  }
+
+  vector_t vel = {eng->cpu_best_speed * cos(eng->cpu_best_angle),
+                  eng->cpu_best_speed * sin(eng->cpu_best_angle)};
+  body_t *arrow = arrow_spawn(eng->level, shooter, vel, eng->equipped_arrow);
+  turn_engine_register_arrow(eng, arrow);
+  eng->cpu_pending = false;
 }
 
 void step_cpu_search(turn_engine_t *eng) {
@@ -131,29 +426,30 @@ void step_cpu_search(turn_engine_t *eng) {
     eng->equipped_arrow = ARROW_STANDARD;
   }
 
-  for (size_t k = 0; k < BATCH_SIZE && eng->cpu_sample_idx < SAMPLES; k++) {
-    double ang = rand_double(MIN_ANGLE, MAX_ANGLE);
-    ang = M_PI - ang;
-    double speed = rand_double(MIN_SPEED, MAX_SPEED);
-    double err = try_shot(eng, ang, speed);
-    if (err < eng->cpu_best_err) {
-      eng->cpu_best_err = err;
-      eng->cpu_best_angle = ang;
-      eng->cpu_best_speed = speed;
+  // with a window up, search only with what is left of the frame's
+  // budget, but always run one batch per frame so the search gets somewhere
+  bool budgeted = !is_headless(eng);
+  uint64_t start = budgeted ? SDL_GetPerformanceCounter() : 0;
+  double budget =
+      budgeted ? CPU_FRAME_BUDGET * SDL_GetPerformanceFrequency() : 0;
+  while (eng->cpu_phase != CPU_SEARCH_DONE) {
+    if (budgeted && eng->frame_searched &&
+        eng->frame_search_ticks + (SDL_GetPerformanceCounter() - start) >=
+            budget) {
+      break;
     }
-    eng->cpu_sample_idx++;
+    advance_cpu_search(eng);
+    eng->frame_searched = true;
+  }
+  if (budgeted) {
+    eng->frame_search_ticks += SDL_GetPerformanceCounter() - start;
   }
 
-  if (eng->cpu_sample_idx >= SAMPLES &&
-      eng->timer <= eng->turn_len - MIN_AI_TURN_TIME) {
-    body_t *shooter =
-        scene_get_body(eng->level->scene, eng->p_body_idx[PLAYER_TWO]);
-    vector_t vel = {eng->cpu_best_speed * cos(eng->cpu_best_angle),
-                    eng->cpu_best_speed * sin(eng->cpu_best_angle)};
-    body_t *arrow =
-        arrow_spawn(eng->level->scene, shooter, vel, eng->equipped_arrow);
-    turn_engine_register_arrow(eng, arrow);
-    eng->cpu_pending = false;
+  // the pause only makes the CPU look like it is thinking, so headless
+  // matches shoot as soon as the search is done
+  if (eng->cpu_phase == CPU_SEARCH_DONE &&
+      (is_headless(eng) || eng->timer <= eng->turn_len - MIN_AI_TURN_TIME)) {
+    fire_cpu_shot(eng);
   }
 }
 
@@ -171,21 +467,31 @@ turn_engine_t *turn_engine_init(level_t *level, camera_t *cam, double turn_len,
   eng->user_zoom = CAM_ZOOM;
   eng->cam_mode = CAM_PLAYER;
   eng->cpu_pending = false;
+  eng->cpu_warm = false;
+  eng->cpu_workers = worker_pool_init(NUM_CPU_SEARCH_THREADS);
+  turn_engine_begin_frame(eng);
   eng->equipped_arrow = ARROW_STANDARD;
   eng->burst_animation_time = 0;
-  camera_set_zoom(cam, CAM_ZOOM);
-  put_camera_on_p1(eng);
-  eng->level->wind = rand_wind(eng);
+  if (!is_headless(eng)) {
+    camera_set_zoom(cam, CAM_ZOOM);
+    put_camera_on_p1(eng);
+  }
+  eng->level->field->wind = rand_wind(eng);
   return eng;
 }
 
 void turn_engine_register_arrow(turn_engine_t *eng, body_t *arrow) {
   eng->burst_animation_time = 0.0;
   eng->tracked_arrow = arrow;
-  arrow_clear_particles();
+  arrow_clear_particles(eng->level);
   enter_arrow_mode(eng);
 }
 
+void turn_engine_begin_frame(turn_engine_t *eng) {
+  eng->frame_search_ticks = 0;
+  eng->frame_searched = false;
+}
+
 void turn_engine_update(turn_engine_t *eng, double dt) {
   eng->timer -= dt;
   if (eng->burst_animation_time > 0.0) {
@@ -201,21 +507,24 @@ void turn_engine_update(turn_engine_t *eng, double dt) {
   }
 
   if (eng->tracked_arrow &&
-      !scene_contains_body(eng->level->scene, eng->tracked_arrow)) {
+      !level_has_body(eng->level, eng->tracked_arrow)) {
     eng->tracked_arrow = NULL;
-    eng->burst_animation_time = 3.0;
+    eng->burst_animation_time = is_headless(eng) ? 0 : BURST_ANIMATION_TIME;
     eng->timer = 0.0;
   }
 
   if (eng->timer <= 0.0) {
     eng->active = eng->active == PLAYER_ONE ? PLAYER_TWO : PLAYER_ONE;
     eng->timer = eng->turn_len;
-    arrow_clear_particles();
+    arrow_clear_particles(eng->level);
     eng->tracked_arrow = NULL;
-    eng->level->wind = rand_wind(eng);
+    eng->level->field->wind = rand_wind(eng);
     enter_player_mode(eng);
     if (rand_double(0, 1) < CRATE_SPAWN_CHANCE) {
-      crate_spawn(eng->level);
+      body_t *crate = crate_spawn(eng->level);
+      if (crate && !is_headless(eng)) {
+        crate_add_sprite(crate);
+      }
     }
   }
 }
@@ -259,6 +568,7 @@ bool turn_engine_arrow_in_flight(turn_engine_t *eng) {
 void turn_engine_destroy(turn_engine_t *eng) {
   level_destroy(eng->level);
   camera_destroy(eng->cam);
+  worker_pool_free(eng->cpu_workers);
   free(eng);
 }
 
@@ -0,0 +1,59 @@
+#include "vector.h"
+
+#include <math.h>
+#include <stddef.h>
+
+const vector_t VEC_ZERO = {.x = 0, .y = 0};
+
+// The out-of-line definitions of the inline functions in vector.h
+extern vector_t vec_add(vector_t v1, vector_t v2);
+extern vector_t vec_subtract(vector_t v1, vector_t v2);
+extern vector_t vec_negate(vector_t v);
+extern vector_t vec_multiply(double scalar, vector_t v);
+extern double vec_dot(vector_t v1, vector_t v2);
+extern double vec_cross(vector_t v1, vector_t v2);
+extern vector_t vec_rotate(vector_t v, double angle);
+extern double vec_get_length(vector_t v);
+
+void vec_batch_translate(double *restrict xs, double *restrict ys, size_t n,
+                         vector_t offset) {
+  for (size_t i = 0; i < n; i++) {
+    xs[i] += offset.x;
+    ys[i] += offset.y;
+  }
+}
+
+void vec_batch_add_scaled(double *restrict xs, double *restrict ys,
+                          const double *restrict dxs,
+                          const double *restrict dys, double scalar,
+                          size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    xs[i] += scalar * dxs[i];
+    ys[i] += scalar * dys[i];
+  }
+}
+
+void vec_batch_scale(double *restrict xs, double *restrict ys, size_t n,
+                     double scalar) {
+  for (size_t i = 0; i < n; i++) {
+    xs[i] *= scalar;
+    ys[i] *= scalar;
+  }
+}
+
+void vec_batch_rotate(double *restrict xs, double *restrict ys, size_t n,
+                      double cos_angle, double sin_angle) {
+  for (size_t i = 0; i < n; i++) {
+    double x = xs[i];
+    double y = ys[i];
+    xs[i] = x * cos_angle - y * sin_angle;
+    ys[i] = x * sin_angle + y * cos_angle;
+  }
+}
+
+void vec_batch_dot(const double *restrict xs, const double *restrict ys,
+                   size_t n, vector_t v, double *restrict out) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = xs[i] * v.x + ys[i] * v.y;
+  }
+}
@@ -0,0 +1,121 @@
+#include "worker_pool.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+struct worker_pool {
+  pthread_t *threads;
+  size_t num_threads;
+  pthread_mutex_t lock;
+  // signalled when a task starts or the pool stops
+  pthread_cond_t work_ready;
+  // signalled when the last index of a task finishes
+  pthread_cond_t work_done;
+  bool stopping;
+  // counts tasks started, so a thread can tell a new task from the last one
+  size_t generation;
+  worker_task_t task;
+  void *aux;
+  size_t count;
+  // the next index to hand out
+  size_t next;
+  size_t finished;
+};
+
+/**
+ * Claims and runs indices of the current task until none are left. Must be
+ * called with the pool's lock held, which is released while an index runs
+ * and held again on return.
+ */
+static void run_claimed(worker_pool_t *pool) {
+  while (pool->next < pool->count) {
+    size_t index = pool->next++;
+    pthread_mutex_unlock(&pool->lock);
+    pool->task(index, pool->aux);
+    pthread_mutex_lock(&pool->lock);
+    pool->finished++;
+  }
+  if (pool->finished == pool->count) {
+    pthread_cond_broadcast(&pool->work_done);
+  }
+}
+
+/**
+ * The loop each of a pool's threads runs: wait for a task, help with it,
+ * repeat until the pool stops.
+ *
+ * @param arg the worker pool
+ */
+static void *worker_main(void *arg) {
+  worker_pool_t *pool = arg;
+  pthread_mutex_lock(&pool->lock);
+  size_t seen = pool->generation;
+  while (true) {
+    while (!pool->stopping && pool->generation == seen) {
+      pthread_cond_wait(&pool->work_ready, &pool->lock);
+    }
+    if (pool->stopping) {
+      break;
+    }
+    seen = pool->generation;
+    run_claimed(pool);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+worker_pool_t *worker_pool_init(size_t num_threads) {
+  worker_pool_t *pool = calloc(1, sizeof(worker_pool_t));
+  assert(pool);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work_ready, NULL);
+  pthread_cond_init(&pool->work_done, NULL);
+  if (num_threads > 0) {
+    pool->threads = malloc(num_threads * sizeof(pthread_t));
+    assert(pool->threads);
+  }
+  while (pool->num_threads < num_threads &&
+         pthread_create(&pool->threads[pool->num_threads], NULL, worker_main,
+                        pool) == 0) {
+    pool->num_threads++;
+  }
+  return pool;
+}
+
+size_t worker_pool_size(const worker_pool_t *pool) {
+  return pool->num_threads;
+}
+
+void worker_pool_run(worker_pool_t *pool, size_t count, worker_task_t task,
+                     void *aux) {
+  pthread_mutex_lock(&pool->lock);
+  pool->task = task;
+  pool->aux = aux;
+  pool->count = count;
+  pool->next = 0;
+  pool->finished = 0;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->work_ready);
+  run_claimed(pool);
+  while (pool->finished < pool->count) {
+    pthread_cond_wait(&pool->work_done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+void worker_pool_free(worker_pool_t *pool) {
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->work_ready);
+  pthread_mutex_unlock(&pool->lock);
+  for (size_t i = 0; i < pool->num_threads; i++) {
+    pthread_join(pool->threads[i], NULL);
+  }
+  pthread_cond_destroy(&pool->work_done);
+  pthread_cond_destroy(&pool->work_ready);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool->threads);
+  free(pool);
+}